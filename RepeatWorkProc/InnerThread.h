@@ -5,6 +5,7 @@
 ///  @class   InnerThread
 ///  @brief   C++11 STL 의 std::thread Wapper class 이다.
 
+#include <string>
 #include <thread>
 #include <chrono>
 
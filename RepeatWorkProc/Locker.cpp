@@ -1,5 +1,183 @@
 ﻿#include "Locker.h"
 
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+
+#ifdef __linux
+#include <climits>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#define LOCKER_MIN_SPIN     (16)    // Wait 에서 spin 하는 최소 횟수
+#define LOCKER_MAX_SPIN     (256)   // Wait 에서 spin 하는 최대 횟수
+
+static_assert(sizeof(std::atomic<int>) == sizeof(int), "futex word must be a plain int");
+
+static long Futex(std::atomic<int>* address, int op, int value, const struct timespec* timeout)
+{
+    return syscall(SYS_futex, reinterpret_cast<int*>(address), op | FUTEX_PRIVATE_FLAG, value, timeout, nullptr, 0);
+}
+
+static void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// CPU 가 하나이면 spin 하는 동안 WakeUp 을 호출할 thread 가 실행될 수 없다.
+static bool CanSpin()
+{
+    static const bool can_spin = std::thread::hardware_concurrency() > 1;
+    return can_spin;
+}
+#endif
+
+#ifdef __linux
+Locker::Locker()
+{
+
+}
+
+Locker::~Locker()
+{
+    if (m_waiters > 0)
+        Futex(&m_lock_count, FUTEX_WAKE, INT_MAX, nullptr);
+}
+
+bool Locker::WaitProc()
+{
+    int count = m_lock_count.load();
+    while (count > 0)
+    {
+        if (m_lock_count.compare_exchange_weak(count, count - 1))
+            return true;    // true 를 return 하면 block 이 풀린다.
+    }
+
+    return false;
+}
+
+// 최근 Wait 에서 spin 으로 깨어나는 데 걸린 횟수의 2배 까지 spin 한다.
+// spin 에 실패하면 평균이 줄어들어 WakeUp 이 드물게 호출되는 Locker 는 거의 spin 하지 않게 된다.
+bool Locker::Spin()
+{
+    if (false == CanSpin())
+        return false;
+
+    int average  = m_spin_count.load(std::memory_order_relaxed);
+    int max_spin = std::min(average * 2 + LOCKER_MIN_SPIN, LOCKER_MAX_SPIN);
+    for (int spin = 0; spin < max_spin; spin++)
+    {
+        CpuRelax();
+        if (m_lock_count.load(std::memory_order_relaxed) > 0 && WaitProc())
+        {
+            m_spin_count.store(average + (spin - average) / 8, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    m_spin_count.store(average - average / 8, std::memory_order_relaxed);
+    return false;
+}
+
+// m_lock_count 가 0 인 동안 futex 에서 잠든다. deadline 이 nullptr 이면 시간 제한이 없다.
+bool Locker::Park(const std::chrono::steady_clock::time_point* deadline)
+{
+    // WakeUp 은 m_lock_count 를 변경한 후에 m_waiters 를 확인하기 때문에
+    // m_waiters 를 증가시킨 후에 m_lock_count 를 다시 확인하면 WakeUp 을 놓치지 않는다.
+    m_waiters++;
+
+    bool ret = false;
+    while (true)
+    {
+        if (WaitProc())
+        {
+            ret = true;
+            break;
+        }
+
+        struct timespec  timeout;
+        struct timespec* timeout_ptr = nullptr;
+        if (deadline)
+        {
+            long long remain = std::chrono::duration_cast<std::chrono::nanoseconds>(*deadline - std::chrono::steady_clock::now()).count();
+            if (remain <= 0)
+                break;
+
+            timeout.tv_sec  = (time_t)(remain / 1000000000);
+            timeout.tv_nsec = (long)(remain % 1000000000);
+            timeout_ptr = &timeout;
+        }
+
+        // m_lock_count 가 0 이 아니면 바로 반환 된다.
+        Futex(&m_lock_count, FUTEX_WAIT, 0, timeout_ptr);
+    }
+
+    m_waiters--;
+    return ret;
+}
+
+bool Locker::Wait()
+{
+    if (WaitProc() || Spin())
+        return true;
+
+    return Park(nullptr);
+}
+
+bool Locker::Wait(int ms)
+{
+    if (WaitProc())
+        return true;
+    if (ms <= 0)
+        return false;
+    if (Spin())
+        return true;
+
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    return Park(&deadline);
+}
+
+void Locker::WakeUp(bool notity_all)
+{
+    m_lock_count.store(m_lock_max_count);
+
+    if (m_waiters.load() > 0)
+        Futex(&m_lock_count, FUTEX_WAKE, notity_all ? INT_MAX : 1, nullptr);
+    if (m_observer_count.load() > 0)
+        NotifyObservers();
+}
+
+bool Locker::TryWait()
+{
+    return WaitProc();
+}
+
+// m_lock_max_count 를 넘지 않게 signal 하나를 되돌린다.
+void Locker::ReturnSignal()
+{
+    int count = m_lock_count.load();
+    while (count < m_lock_max_count)
+    {
+        if (m_lock_count.compare_exchange_weak(count, count + 1))
+            break;
+    }
+
+    if (m_waiters.load() > 0)
+        Futex(&m_lock_count, FUTEX_WAKE, 1, nullptr);
+    if (m_observer_count.load() > 0)
+        NotifyObservers();
+}
+#else
 Locker::Locker()
 {
 
@@ -55,6 +233,143 @@ void Locker::WakeUp(bool notity_all)
         m_condition_variable.notify_all();
     else
         m_condition_variable.notify_one();
+
+    if (m_observer_count.load() > 0)
+        NotifyObservers();
+}
+
+bool Locker::TryWait()
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    return WaitProc();
+}
+
+// m_lock_max_count 를 넘지 않게 signal 하나를 되돌린다.
+void Locker::ReturnSignal()
+{
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        if (m_lock_count < m_lock_max_count)
+            m_lock_count++;
+    }
+
+    m_condition_variable.notify_one();
+    if (m_observer_count.load() > 0)
+        NotifyObservers();
+}
+#endif
+
+void Locker::NotifyObservers()
+{
+    std::lock_guard<std::mutex> lock(m_observer_mutex);
+    for (Locker* observer : m_observers)
+        observer->WakeUp();
+}
+
+void Locker::AddObserver(Locker* observer)
+{
+    std::lock_guard<std::mutex> lock(m_observer_mutex);
+    m_observers.push_back(observer);
+    m_observer_count++;
+}
+
+void Locker::DeleteObserver(Locker* observer)
+{
+    std::lock_guard<std::mutex> lock(m_observer_mutex);
+    auto it = std::find(m_observers.begin(), m_observers.end(), observer);
+    if (it != m_observers.end())
+    {
+        m_observers.erase(it);
+        m_observer_count--;
+    }
+}
+
+// observer 로 등록된 event 로 WakeUp 을 전달 받으면서 check 가 true 를 반환할 때까지 기다린다.
+// event 를 등록한 후에 check 를 호출하기 때문에 그 사이에 호출된 WakeUp 도 놓치지 않는다.
+template <typename CheckFunc>
+static bool WaitLockers(int ms, Locker& event, CheckFunc check)
+{
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms > 0 ? ms : 0);
+    while (false == check())
+    {
+        if (ms < 0)
+        {
+            event.Wait();
+            continue;
+        }
+
+        long long remain = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remain <= 0)
+            return false;
+
+        event.Wait((int)((remain + 999) / 1000));
+    }
+
+    return true;
+}
+
+int Locker::WaitAny(const std::vector<Locker*>& lockers, std::vector<size_t>& fired, int ms)
+{
+    fired.clear();
+    if (lockers.empty())
+        return 2;
+
+    Locker event;
+    for (Locker* locker : lockers)
+        locker->AddObserver(&event);
+
+    bool ret = WaitLockers(ms, event, [&]() {
+        for (size_t index = 0; index < lockers.size(); index++)
+        {
+            if (lockers[index]->TryWait())
+                fired.push_back(index);
+        }
+        return fired.size() > 0;
+    });
+
+    for (Locker* locker : lockers)
+        locker->DeleteObserver(&event);
+
+    return ret ? 0 : 1;
+}
+
+int Locker::WaitAll(const std::vector<Locker*>& lockers, int ms)
+{
+    if (lockers.empty())
+        return 2;
+
+    Locker event;
+    for (Locker* locker : lockers)
+        locker->AddObserver(&event);
+
+    std::vector<bool> acquired(lockers.size(), false);
+    size_t remain = lockers.size();
+    bool ret = WaitLockers(ms, event, [&]() {
+        for (size_t index = 0; index < lockers.size(); index++)
+        {
+            if (false == acquired[index] && lockers[index]->TryWait())
+            {
+                acquired[index] = true;
+                remain--;
+            }
+        }
+        return 0 == remain;
+    });
+
+    for (Locker* locker : lockers)
+        locker->DeleteObserver(&event);
+
+    // 시간 초과 시에는 다른 thread 가 받을 수 있도록 소비한 signal 을 되돌린다.
+    if (false == ret)
+    {
+        for (size_t index = 0; index < lockers.size(); index++)
+        {
+            if (acquired[index])
+                lockers[index]->ReturnSignal();
+        }
+    }
+
+    return ret ? 0 : 1;
 }
 
 void Locker::SetWakeUpCount(int count)
@@ -65,4 +380,98 @@ void Locker::SetWakeUpCount(int count)
 int Locker::GetLockCount() const
 {
     return m_lock_max_count;
-}
\ No newline at end of file
+}
+
+// Bench 에서 비교하는 mutex, condition_variable 로 구현한 Locker
+class CondVarLocker
+{
+private:
+    int                         m_lock_count = 0;
+    std::mutex                  m_mutex;
+    std::condition_variable     m_condition_variable;
+
+public:
+    bool Wait()
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        m_condition_variable.wait(locker, [this] {
+            if (m_lock_count > 0)
+            {
+                m_lock_count--;
+                return true;
+            }
+            return false;
+        });
+
+        return true;
+    }
+
+    void WakeUp()
+    {
+        {
+            std::unique_lock<std::mutex> locker(m_mutex);
+            m_lock_count = 1;
+        }
+        m_condition_variable.notify_one();
+    }
+};
+
+// ping 을 깨운 시간부터 상대 thread 가 Wait() 에서 깨어날 때까지의 시간을 측정 한다.
+// gap 만큼 쉬었다가 깨우면 상대 thread 는 spin 을 끝내고 잠들어 있는 상태에서 깨어나게 된다.
+template <typename LockerType>
+static void BenchWakeup(const char* name, int count, std::chrono::microseconds gap)
+{
+    typedef std::chrono::steady_clock chrono_clock;
+
+    LockerType ping;
+    LockerType pong;
+    std::vector<chrono_clock::time_point> send_times(count);
+    std::vector<long long>                latencies(count);
+
+    std::thread receiver([&]() {
+        for (int ii = 0; ii < count; ii++)
+        {
+            ping.Wait();
+            latencies[ii] = std::chrono::duration_cast<std::chrono::nanoseconds>(chrono_clock::now() - send_times[ii]).count();
+            pong.WakeUp();
+        }
+    });
+
+    chrono_clock::time_point begin = chrono_clock::now();
+    for (int ii = 0; ii < count; ii++)
+    {
+        if (gap.count())
+            std::this_thread::sleep_for(gap);
+        send_times[ii] = chrono_clock::now();
+        ping.WakeUp();
+        pong.Wait();
+    }
+    double elapsed = std::chrono::duration<double, std::micro>(chrono_clock::now() - begin).count();
+    receiver.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    double average = 0;
+    for (long long latency : latencies)
+        average += latency;
+    average /= count;
+
+    printf("%-10s gap %5lld us : wakeup avg %8.2f us, p50 %8.2f us, p99 %8.2f us, round trip %8.2f us\n",
+        name, (long long)gap.count(), average / 1000.0, latencies[count / 2] / 1000.0, latencies[count * 99 / 100] / 1000.0,
+        elapsed / count);
+}
+
+int BenchLockerWakeup()
+{
+    enum
+    {
+        BUSY_COUNT = 100000,    // 쉬지 않고 주고 받는 횟수
+        IDLE_COUNT = 2000,      // 잠든 thread 를 깨우는 횟수
+    };
+
+    BenchWakeup<CondVarLocker>("condvar", BUSY_COUNT, std::chrono::microseconds(0));
+    BenchWakeup<Locker>("Locker", BUSY_COUNT, std::chrono::microseconds(0));
+    BenchWakeup<CondVarLocker>("condvar", IDLE_COUNT, std::chrono::microseconds(200));
+    BenchWakeup<Locker>("Locker", IDLE_COUNT, std::chrono::microseconds(200));
+
+    return 0;
+}
@@ -3,24 +3,50 @@
 ///  @author  Lee Jong Oh
 
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <vector>
 #include <condition_variable>
 
 /**
  * @brief The UniqueLock class
  * wrapper for mutex and unique_lock.
  * Windows api 의 class CEvent 와 같은 기능을 갖는 C++11 STL Wapper class 이다.
+ * Linux 에서는 futex 로 구현되어 WakeUp, Wait 이 경합하지 않으면 system call 없이 atomic 연산만으로 처리 된다.
+ * Wait 은 잠시 spin 하면서 WakeUp 을 기다린 후에 잠들며 spin 횟수는 최근에 성공한 spin 횟수에 맞춰 조절 된다.
  */
 class Locker 
 {
 private:
+#ifdef __linux
+    std::atomic<int>            m_lock_count{ 0 };      // futex word
+    std::atomic<int>            m_waiters{ 0 };         // futex 에서 잠들어 있거나 잠들려고 하는 thread 수
+    std::atomic<int>            m_spin_count{ 0 };      // 최근 Wait 의 spin 횟수 평균
+    int                         m_lock_max_count = 1;
+#else
     int                         m_lock_count     = 0;
     int                         m_lock_max_count = 1;
 
     std::mutex                  m_mutex;
     std::condition_variable     m_condition_variable;
+#endif
+
+    // WaitAny(), WaitAll() 에서 이 Locker 를 기다리는 동안 WakeUp 을 전달 받는 Locker
+    std::atomic<int>            m_observer_count{ 0 };
+    std::mutex                  m_observer_mutex;
+    std::vector<Locker*>        m_observers;
 
 private:
     bool WaitProc();
+#ifdef __linux
+    bool Spin();
+    bool Park(const std::chrono::steady_clock::time_point* deadline);
+#endif
+    bool TryWait();
+    void ReturnSignal();
+    void NotifyObservers();
+    void AddObserver(Locker* observer);
+    void DeleteObserver(Locker* observer);
 
 public:
     Locker();
@@ -33,5 +59,23 @@ public:
     // 설정된 count 만큼 WakeUp function 을 호출 해주어야 Wait function 의 Block 이 풀린다.
     void SetWakeUpCount(int count);
     int  GetLockCount() const;
+
+    ///  @brief : 여러 Locker (CTimerLocker) 중에서 하나 이상이 WakeUp 될 때까지 기다린다. (WaitForMultipleObjects)
+    ///           WakeUp 된 Locker 는 모두 Wait() 한 것과 같이 signal 이 소비 된다.
+    ///  @param lockers[in] : 기다릴 Locker 목록
+    ///  @param fired[out] : WakeUp 된 Locker 의 lockers 내부 index
+    ///  @param ms[in] : 기다리는 시간 (millisecond), 음수이면 WakeUp 될 때까지 기다린다.
+    ///  @return : 성공 시에 0, 시간 초과 시에 1, lockers 가 비어 있으면 2
+    static int WaitAny(const std::vector<Locker*>& lockers, std::vector<size_t>& fired, int ms = -1);
+
+    ///  @brief : 모든 Locker (CTimerLocker) 가 WakeUp 될 때까지 기다린다.
+    ///           WakeUp 된 Locker 의 signal 을 먼저 소비하면서 나머지를 기다리며 시간 초과 시에는 소비한 signal 을 되돌려 놓는다.
+    ///  @param lockers[in] : 기다릴 Locker 목록
+    ///  @param ms[in] : 기다리는 시간 (millisecond), 음수이면 모두 WakeUp 될 때까지 기다린다.
+    ///  @return : 성공 시에 0, 시간 초과 시에 1, lockers 가 비어 있으면 2
+    static int WaitAll(const std::vector<Locker*>& lockers, int ms = -1);
 };
 
+///  @brief : 다른 thread 에서 WakeUp() 을 호출한 후 Wait() 에서 깨어날 때까지의 시간을
+///           condition_variable 로 구현한 Locker 와 비교하여 출력 한다.
+int BenchLockerWakeup();
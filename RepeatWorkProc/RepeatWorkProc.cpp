@@ -1,9 +1,404 @@
 ﻿#include "RepeatWorkProc.h"
 #include "TimerLockerManager.h"
+#include "TimerEx.h"
+
+#include <deque>
+#include <map>
+#include <queue>
+#include <algorithm>
+#include <cstdint>
+
+//////////////////////////////////////////////////////////////////////////
+///  @struct  RepeatWorkProc::WorkerJob
+///  @brief   worker 가 처리할 Work event 또는 task 이다.
+
+struct RepeatWorkProc::WorkerJob
+{
+    bool        is_task = false;
+    RepeatEvent event;
+    TaskId      task_id = 0;
+    long long   enqueue_ns = 0;     // queue 에 넣은 시간 (steady_clock 의 epoch 기준 nanosecond)
+};
+
+//////////////////////////////////////////////////////////////////////////
+///  @struct  RepeatWorkProc::WorkDispatch
+///  @brief   Work 의 Timer callback 과 worker 가 lock 없이 공유하는 상태이다.
+///           queued 가 true 인 동안은 job 이 queue 에 있거나 어떤 worker 가 실행 중이므로 Timer event 는 count, ticks 에만 더한다.
+///           queued 를 false 에서 true 로 바꾼 쪽만 job 을 넣거나 실행하므로 같은 Work 는 동시에 실행되지 않는다.
+///           work, policy, stats 는 Timer 를 등록하기 전에 정해진 후 바뀌지 않으므로 worker 는 m_queue_repeat_mutex 없이 읽는다.
+
+struct RepeatWorkProc::WorkDispatch
+{
+    std::atomic<int>        affinity{ -1 };     // 마지막으로 실행한 worker, 다음 job 을 같은 worker 로 보낸다.
+    std::atomic<bool>       queued{ false };
+    std::atomic<int>        count{ 0 };         // 처리되지 않은 Timer event 수
+    std::atomic<int>        ticks{ 0 };         // 처리되지 않은 Timer event 들의 tick_count 합
+    std::atomic<long long>  deadline{ 0 };      // 처리되지 않은 event 중 가장 오래된 것의 deadline (clock 의 epoch 기준 nanosecond)
+    std::atomic<bool>       deleted{ false };   // DeleteWork() 로 삭제되었으면 queue 에 남은 job 을 실행하지 않는다.
+
+    RepeatWorkEx                    work;
+    OverrunPolicy                   policy = OVERRUN_SKIP;
+    std::shared_ptr<CTimerStats>    stats;      // Work 가 실행된 간격, deadline 대비 지연
+};
+
+//////////////////////////////////////////////////////////////////////////
+///  @class   CWorkStealingDeque
+///  @brief   Chase-Lev work-stealing deque 이다.
+///           소유한 worker 는 bottom 에서 Push(), Pop() 하여 가장 최근 항목부터 (LIFO) 처리하고
+///           다른 worker 는 top 에서 Steal() 하여 가장 오래된 항목부터 (FIFO) 가져간다.
+///           소유한 worker 도 오래 기다린 항목을 먼저 처리하기 위해 Steal() 을 호출할 수 있다.
+///           항목마다 넣은 시간을 함께 저장하여 GetTopStamp() 로 가장 오래된 항목이 기다린 시간을 알 수 있다.
+///           크기가 고정되어 있으며 가득 차면 Push() 가 실패 한다.
+
+template <typename T>
+class CWorkStealingDeque
+{
+private:
+    enum { CAPACITY = 1024, MASK = CAPACITY - 1 };
+
+    std::atomic<long long>  m_top{ 0 };
+    std::atomic<long long>  m_bottom{ 0 };
+    std::atomic<T*>         m_buffer[CAPACITY];
+    std::atomic<long long>  m_stamps[CAPACITY];
+
+public:
+    CWorkStealingDeque()
+    {
+        for (int index = 0; index < CAPACITY; index++)
+        {
+            m_buffer[index].store(nullptr, std::memory_order_relaxed);
+            m_stamps[index].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    bool Push(T* item, long long stamp)
+    {
+        long long bottom = m_bottom.load(std::memory_order_relaxed);
+        long long top    = m_top.load(std::memory_order_acquire);
+        if (bottom - top >= CAPACITY)
+            return false;
+
+        m_stamps[bottom & MASK].store(stamp, std::memory_order_relaxed);
+        m_buffer[bottom & MASK].store(item, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    T* Pop()
+    {
+        long long bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long top = m_top.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T* item = m_buffer[bottom & MASK].load(std::memory_order_relaxed);
+        if (top == bottom)
+        {
+            // 마지막 항목은 Steal() 과 경쟁 한다.
+            if (false == m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                item = nullptr;
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    T* Steal()
+    {
+        long long top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom)
+            return nullptr;
+
+        T* item = m_buffer[top & MASK].load(std::memory_order_acquire);
+        if (false == m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return item;
+    }
+
+    bool Empty() const
+    {
+        return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+    }
+
+    ///  @brief : top 항목을 넣을 때 저장한 stamp 를 반환 한다. 다른 thread 가 Steal() 하는 중이면 이미 꺼내진 항목의 값일 수 있다.
+    ///  @return : 비어 있으면 -1
+    long long GetTopStamp() const
+    {
+        long long top = m_top.load(std::memory_order_acquire);
+        if (m_bottom.load(std::memory_order_relaxed) <= top)
+            return -1;
+        return m_stamps[top & MASK].load(std::memory_order_relaxed);
+    }
+
+    ///  @brief : 더 넣을 수 있는 항목 수, 소유한 worker 에서 호출하면 실제 값 이상이 보장 되지 않는 대신 넘치지 않는다.
+    long long Available() const
+    {
+        return CAPACITY - (m_bottom.load(std::memory_order_relaxed) - m_top.load(std::memory_order_acquire));
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+///  @class   CMpmcRing
+///  @brief   크기가 고정된 lock-free multi-producer / multi-consumer ring buffer 이다. (Vyukov bounded queue)
+///           slot 마다 sequence 를 두어 producer 와 consumer 가 서로 다른 slot 을 CAS 한번으로 차지 한다.
+///           생성 이후에는 메모리를 할당하지 않는다.
+
+template <typename T>
+class CMpmcRing
+{
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T                   data;
+    };
+
+    // producer 와 consumer 의 위치가 같은 cache line 을 공유하지 않도록 떨어뜨린다.
+    std::unique_ptr<Cell[]>         m_cells;
+    size_t                          m_mask;
+    char                            m_pad0[64];
+    std::atomic<size_t>             m_enqueue_pos{ 0 };
+    char                            m_pad1[64];
+    std::atomic<size_t>             m_dequeue_pos{ 0 };
+    char                            m_pad2[64];
+
+public:
+    ///  @param capacity[in] : 2의 거듭제곱
+    explicit CMpmcRing(size_t capacity)
+        : m_cells(new Cell[capacity])
+        , m_mask(capacity - 1)
+    {
+        for (size_t index = 0; index < capacity; index++)
+            m_cells[index].sequence.store(index, std::memory_order_relaxed);
+    }
+
+    ///  @return : 가득 차 있으면 false
+    bool TryPush(const T& item)
+    {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell&    cell = m_cells[pos & m_mask];
+            intptr_t diff = (intptr_t)cell.sequence.load(std::memory_order_acquire) - (intptr_t)pos;
+            if (0 == diff)
+            {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.data = item;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    ///  @brief : 연속으로 채워진 slot 들을 CAS 한번으로 차지하여 최대 max_count 개를 꺼낸다.
+    ///  @return : 꺼낸 항목 수, 비어 있으면 0
+    size_t PopBatch(T* items, size_t max_count)
+    {
+        size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            size_t count = 0;
+            while (count < max_count && m_cells[(pos + count) & m_mask].sequence.load(std::memory_order_acquire) == pos + count + 1)
+                count++;
+
+            if (0 == count)
+            {
+                intptr_t diff = (intptr_t)m_cells[pos & m_mask].sequence.load(std::memory_order_acquire) - (intptr_t)(pos + 1);
+                if (diff < 0)
+                    return 0;
+
+                // 다른 consumer 가 먼저 가져갔다.
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (m_dequeue_pos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+            {
+                for (size_t index = 0; index < count; index++)
+                {
+                    Cell& cell = m_cells[(pos + index) & m_mask];
+                    items[index] = std::move(cell.data);
+                    cell.sequence.store(pos + index + m_mask + 1, std::memory_order_release);
+                }
+                return count;
+            }
+        }
+    }
+
+    bool TryPop(T& item)
+    {
+        return 1 == PopBatch(&item, 1);
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+///  @class   RepeatWorkProc::CWorkerQueue
+///  @brief   worker 별 queue 이다.
+///           Timer thread 는 deque 에 직접 넣을 수 없으므로 lock-free inbox 에 넣고, worker 가 inbox 를 자신의 deque 로 옮긴다.
+///           다 쓴 job 은 m_free_jobs 로 돌려보내 재사용하므로 정상 상태에서는 메모리를 할당하지 않는다.
+
+class RepeatWorkProc::CWorkerQueue
+{
+public:
+    enum
+    {
+        INBOX_CAPACITY    = 1024,
+        FREE_JOB_CAPACITY = 1024,
+        INBOX_BATCH       = 64,     // 한번에 inbox 에서 꺼내는 job 수
+    };
+
+    Locker                          m_event;
+    std::atomic<bool>               m_pending{ false };     // Timer batch 에서 inbox 에 추가된 job 이 있는지 여부
+    CMpmcRing<WorkerJob*>           m_inbox{ INBOX_CAPACITY };
+    CMpmcRing<WorkerJob*>           m_free_jobs{ FREE_JOB_CAPACITY };
+    CWorkStealingDeque<WorkerJob>   m_deque;
+
+    // inbox 가 가득 찬 경우에만 사용 한다.
+    std::atomic<int>                m_overflow_count{ 0 };
+    std::mutex                      m_overflow_mutex;       // 다른 lock 을 잡지 않는다.
+    std::deque<WorkerJob*>          m_overflow;
+
+    ~CWorkerQueue()
+    {
+        Clear();
+        WorkerJob* job = nullptr;
+        while (m_free_jobs.TryPop(job))
+            delete job;
+    }
+
+    WorkerJob* AllocJob()
+    {
+        WorkerJob* job = nullptr;
+        if (m_free_jobs.TryPop(job))
+            return job;
+        return new WorkerJob();
+    }
+
+    void FreeJob(WorkerJob* job)
+    {
+        job->event = RepeatEvent();     // 삭제된 Work 의 WorkDispatch 를 붙잡고 있지 않도록 한다.
+        if (false == m_free_jobs.TryPush(job))
+            delete job;
+    }
+
+    void Push(WorkerJob* job)
+    {
+        if (m_inbox.TryPush(job))
+            return;
+
+        std::lock_guard<std::mutex> lock(m_overflow_mutex);
+        m_overflow.push_back(job);
+        m_overflow_count++;
+    }
+
+    ///  @brief : inbox, overflow 의 job 을 deque 에 들어가는 만큼 옮긴다. 소유한 worker 만 호출 한다.
+    ///  @return : 옮기지 못하고 남은 job 이 있을 수 있으면 true
+    bool MoveToDeque()
+    {
+        WorkerJob* jobs[INBOX_BATCH];
+        while (true)
+        {
+            long long available = std::min<long long>(m_deque.Available(), INBOX_BATCH);
+            if (available <= 0)
+                return true;
+
+            size_t count = m_inbox.PopBatch(jobs, (size_t)available);
+            for (size_t index = 0; index < count; index++)
+                m_deque.Push(jobs[index], jobs[index]->enqueue_ns);
+            if (count < (size_t)available)
+                break;
+        }
+
+        if (0 == m_overflow_count.load())
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_overflow_mutex);
+        while (m_overflow.size() && m_deque.Push(m_overflow.front(), m_overflow.front()->enqueue_ns))
+        {
+            m_overflow.pop_front();
+            m_overflow_count--;
+        }
+        return m_overflow.size() > 0;
+    }
+
+    ///  @brief : 다른 worker 가 inbox 에서 job 을 가져간다.
+    WorkerJob* StealInbox()
+    {
+        WorkerJob* job = nullptr;
+        if (m_inbox.TryPop(job))
+            return job;
+        return nullptr;
+    }
+
+    void Clear()
+    {
+        while (WorkerJob* job = m_deque.Pop())
+            FreeJob(job);
+
+        WorkerJob* job = nullptr;
+        while (m_inbox.TryPop(job))
+            FreeJob(job);
+
+        std::lock_guard<std::mutex> lock(m_overflow_mutex);
+        for (WorkerJob* overflow_job : m_overflow)
+            FreeJob(overflow_job);
+        m_overflow.clear();
+        m_overflow_count = 0;
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+///  @class   RepeatWorkProc::CWorkerThread
+///  @brief   RepeatWorkProc 의 ThreadLoop 외에 추가로 Work 를 실행하는 thread 이다.
+
+class RepeatWorkProc::CWorkerThread : public InnerThread
+{
+private:
+    RepeatWorkProc& m_owner;
+    int             m_index;
+
+protected:
+    virtual void ThreadLoop() override
+    {
+        m_owner.WorkerLoop(m_index);
+    }
+
+public:
+    CWorkerThread(RepeatWorkProc& owner, int index)
+        : m_owner(owner)
+        , m_index(index)
+    {
+        InnerThread::SaveThreadName("RepeatWorkProc_" + std::to_string(index));
+        InnerThread::StartThread();
+    }
+    virtual ~CWorkerThread()
+    {
+        InnerThread::JoinThread();
+    }
+};
 
 RepeatWorkProc::RepeatWorkProc()
 {
     InnerThread::SaveThreadName("RepeatWorkProc");
+    m_worker_queues.emplace_back(new CWorkerQueue());
 }
 
 RepeatWorkProc::~RepeatWorkProc()
@@ -16,7 +411,29 @@ int RepeatWorkProc::Activate()
     if (m_thread_running)
         return 1;
 
+    // Timer tick 마다 추가된 Work 들을 모아서 Thread 를 한번만 깨운다.
+    CTimerLockerManager& timer_manager = CTimerLockerManager::GetInstance();
+    m_batch_callback_id = timer_manager.AddBatchCallback([this]() {
+        if (false == m_batch_pending.exchange(false))
+            return;
+
+        for (int index = 0; index < (int)m_worker_queues.size(); index++)
+        {
+            CWorkerQueue& queue = *m_worker_queues[index];
+            if (false == queue.m_pending.exchange(false))
+                continue;
+
+            queue.m_event.WakeUp();
+            // 받은 worker 가 실행 중이면 쉬는 worker 가 가져갈 수 있도록 깨운다.
+            if (0 == (m_idle_workers.load() & (1ULL << index)))
+                WakeIdleWorker(index);
+        }
+    });
+
+    m_thread_running = true;
     InnerThread::StartThread();
+    for (int index = 1; index < m_worker_count; index++)
+        m_workers.emplace_back(new CWorkerThread(*this, index));
 
     return 0;
 }
@@ -24,18 +441,32 @@ int RepeatWorkProc::Activate()
 int RepeatWorkProc::Deactivate()
 {
     CTimerLockerManager& timer_manager = CTimerLockerManager::GetInstance();
-    for (auto it_timer = m_map_timer.begin() ; it_timer != m_map_timer.end() ; it_timer++)
-        timer_manager.DeleteTimerLocker(it_timer->second);
+    timer_manager.DeleteBatchCallback(m_batch_callback_id);
+    m_batch_callback_id = 0;
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_queue_repeat_mutex);
+        for (WorkItem& item : m_work_slots)
+        {
+            if (item.used)
+                FreeWork(item);
+        }
 
-    m_map_timer.clear();
-    m_map_work.clear();
+        for (auto it_task = m_map_task.begin(); it_task != m_map_task.end(); it_task++)
+            timer_manager.DeleteTimerTask(it_task->second.timer_task_id);
+        m_map_task.clear();
+    }
 
     m_thread_running = false;
-    m_queue_repeat_event.WakeUp();
+    for (auto& queue : m_worker_queues)
+        queue->m_event.WakeUp();
     InnerThread::JoinThread();
+    m_workers.clear();
 
-    while (m_queue_repeat_work.size())
-        m_queue_repeat_work.pop();
+    for (auto& queue : m_worker_queues)
+        queue->Clear();
+    m_idle_workers  = 0;
+    m_backlog_depth = 0;
 
     return 0;
 }
@@ -45,81 +476,537 @@ std::string RepeatWorkProc::GetTimerName(int work_type) const
     return std::string("RepeatTimer_" + std::to_string(work_type));
 }
 
+RepeatWorkProc::WorkItem* RepeatWorkProc::FindWork(WorkHandle handle)
+{
+    size_t index = (size_t)(handle & 0xFFFFFFFF);
+    if (index >= m_work_slots.size())
+        return nullptr;
+
+    WorkItem& item = m_work_slots[index];
+    if (false == item.used || item.generation != (unsigned int)(handle >> 32))
+        return nullptr;
+
+    return &item;
+}
+
+RepeatWorkProc::WorkItem* RepeatWorkProc::FindWork(int work_type)
+{
+    auto it = m_work_handles.find(work_type);
+    if (it == m_work_handles.end())
+        return nullptr;
+
+    return FindWork(it->second);
+}
+
+void RepeatWorkProc::FreeWork(WorkItem& item)
+{
+    if (item.timer)
+        CTimerLockerManager::GetInstance().DeleteTimerLocker(item.timer);
+    if (item.dispatch)
+        item.dispatch->deleted = true;
+
+    m_work_handles.erase(item.work_type);
+
+    // 삭제된 Work 의 handle 이 새로 등록된 Work 와 겹치지 않도록 generation 을 올린다.
+    unsigned int generation = item.generation + 1;
+    item = WorkItem();
+    item.generation = generation;
+    m_free_work_slots.push_back((unsigned int)(&item - m_work_slots.data()));
+}
+
 int RepeatWorkProc::AddWork(int work_type, int ms, const RepeatWork& work)
 {
-    auto it = m_map_work.find(work_type);
-    if (it != m_map_work.end())
+    return AddWork(work_type, std::chrono::milliseconds(ms), work);
+}
+
+int RepeatWorkProc::AddWork(int work_type, std::chrono::nanoseconds period, const RepeatWork& work)
+{
+    auto work_ex = [work](int) {
+        if (work)
+            work();
+    };
+
+    return AddWork(work_type, period, work_ex, OVERRUN_SKIP);
+}
+
+int RepeatWorkProc::AddWork(int work_type, std::chrono::nanoseconds period, const RepeatWorkEx& work, OverrunPolicy policy)
+{
+    // Timer callback 은 RepeatWorkProc 의 lock 을 잡지 않으므로 등록이 끝날 때까지 lock 을 유지해도 된다.
+    std::lock_guard<std::recursive_mutex> lock(m_queue_repeat_mutex);
+
+    if (m_work_handles.count(work_type))
         return 1;
 
     CTimerLockerManager& timer_manager = CTimerLockerManager::GetInstance();
 
+    if (period < timer_manager.GetTimerMinResolutionNs())
+        period = timer_manager.GetTimerMinResolutionNs();
+
+    long long phase = m_phase_stagger ? SelectPhase(period.count()) : -1;
+
+    unsigned int index = 0;
+    if (m_free_work_slots.size())
     {
-        std::lock_guard<std::recursive_mutex> lock(m_queue_repeat_mutex);
-        m_map_work[work_type] = work;
+        index = m_free_work_slots.back();
+        m_free_work_slots.pop_back();
+    }
+    else
+    {
+        index = (unsigned int)m_work_slots.size();
+        m_work_slots.emplace_back();
     }
 
-    std::string timer_name = GetTimerName(work_type);
+    WorkHandle work_handle = ((WorkHandle)m_work_slots[index].generation << 32) | index;
+    std::shared_ptr<WorkDispatch> dispatch = std::make_shared<WorkDispatch>();
+    dispatch->work   = work;
+    dispatch->policy = policy;
+    dispatch->stats  = std::make_shared<CTimerStats>();
 
-    auto func = [this, work_type](const CTimerLocker& locker) {
-        m_queue_repeat_work.push(work_type);
-        m_queue_repeat_event.WakeUp();
+    auto func = [this, policy, dispatch](const CTimerLocker& locker) {
+        std::chrono::steady_clock::time_point deadline = locker.GetLastDeadline();
+        if (0 == dispatch->count.fetch_add(1))
+            dispatch->deadline = deadline.time_since_epoch().count();
+        dispatch->ticks += OVERRUN_COALESCE == policy ? locker.GetMissedCount() + 1 : 1;
+
+        // 이미 대기 중이거나 실행 중이면 그 job 에 합친다.
+        if (dispatch->queued.exchange(true))
+        {
+            m_backlog_coalesced++;
+            return;
+        }
+
+        int max_backlog = m_max_backlog.load(std::memory_order_relaxed);
+        if (max_backlog > 0 && m_backlog_depth.load() >= max_backlog)
+        {
+            // 누적된 tick 은 남겨두고 다음 주기에 다시 시도 한다.
+            dispatch->queued = false;
+            m_backlog_deferred++;
+            return;
+        }
+
+        WorkerJob job;
+        job.event.dispatch = dispatch;
+
+        PushJob(dispatch->affinity.load(std::memory_order_relaxed), job);
     };
 
-    CTimerLocker* timer = timer_manager.GetTimerLockerByTime(timer_name, ms, func);
+    std::string   timer_name = GetTimerName(work_type);
+    CTimerLocker* timer      = nullptr;
+    if (phase >= 0)
+    {
+        CTimerLockerManager::TimerLockerHandle handle = 0;
+        if (0 == timer_manager.AddTimerLocker(handle, timer_name, period, std::chrono::nanoseconds(phase), func))
+            timer = timer_manager.GetTimerLocker(handle);
+    }
+    else
+    {
+        timer = timer_manager.GetTimerLockerByTime(timer_name, period, func);
+    }
+
+    if (nullptr == timer)
+    {
+        m_free_work_slots.push_back(index);
+        return 2;
+    }
+
+    if (OVERRUN_BURST == policy)
+        timer_manager.SetTimerLockerOverrunPolicy(timer, CTimerLocker::OVERRUN_BURST);
 
-    m_map_timer[work_type] = timer;
+    WorkItem& item = m_work_slots[index];
+    item.work_type = work_type;
+    item.used      = true;
+    item.timer     = timer;
+    item.work      = work;
+    item.policy    = policy;
+    item.period    = period.count();
+    item.phase     = phase;
+    item.stats     = dispatch->stats;
+    item.dispatch  = dispatch;
+    m_work_handles[work_type] = work_handle;
 
     return 0;
 }
 
-int RepeatWorkProc::DeleteWork(int work_type)
+long long RepeatWorkProc::SelectPhase(long long period) const
+{
+    // 위상 후보는 주기를 2의 거듭제곱 (최대 1024) 으로 나눈 간격이며, 간격은 최소 해상도 이상이어야 한다.
+    long long min_tick = CTimerLockerManager::GetInstance().GetTimerMinResolutionNs().count();
+    int bits = 0;
+    while (bits < 10 && 0 == period % (2LL << bits) && period / (2LL << bits) >= min_tick)
+        bits++;
+
+    int       slot_count = 1 << bits;
+    long long slot_ns    = period / slot_count;
+
+    std::vector<int> usage(slot_count, 0);
+    for (const WorkItem& item : m_work_slots)
+    {
+        if (item.used && item.period == period && item.phase >= 0)
+            usage[(item.phase / slot_ns) % slot_count]++;
+    }
+
+    // bit 역순 (0, 1/2, 1/4, 3/4, ...) 으로 방문하여 앞서 배치된 위상들과 최대한 멀리 떨어진 후보를 먼저 고른다.
+    int best_slot = 0;
+    for (int index = 0; index < slot_count; index++)
+    {
+        int slot = 0;
+        for (int bit = 0; bit < bits; bit++)
+        {
+            if (index & (1 << bit))
+                slot |= 1 << (bits - 1 - bit);
+        }
+
+        if (usage[slot] < usage[best_slot])
+            best_slot = slot;
+    }
+
+    return best_slot * slot_ns;
+}
+
+int RepeatWorkProc::SetWorkerCount(int count)
 {
-    auto it_work = m_map_work.find(work_type);
-    if (it_work == m_map_work.end())
+    if (m_thread_running)
         return 1;
+    if (count < 1 || count > 64)
+        return 2;
+
+    // Timer callback 이 worker queue 를 참조하므로 등록된 Work, task 가 없을 때만 바꿀 수 있다.
+    std::lock_guard<std::recursive_mutex> lock(m_queue_repeat_mutex);
+    if (m_work_handles.size() || m_map_task.size())
+        return 3;
+
+    m_worker_count = count;
+    m_worker_queues.clear();
+    for (int index = 0; index < count; index++)
+        m_worker_queues.emplace_back(new CWorkerQueue());
+
+    return 0;
+}
 
-    auto it_timer = m_map_timer.find(work_type);
-    if (it_timer == m_map_timer.end())
+int RepeatWorkProc::SetPhaseStagger(bool enable)
+{
+    m_phase_stagger = enable;
+    return 0;
+}
+
+int RepeatWorkProc::GetLoadHistogram(std::chrono::nanoseconds window, std::vector<int>& histogram)
+{
+    std::vector<CTimerLocker*> lockers;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_queue_repeat_mutex);
+        for (const WorkItem& item : m_work_slots)
+        {
+            if (item.used)
+                lockers.push_back(item.timer);
+        }
+    }
+
+    if (lockers.empty())
+    {
+        histogram.clear();
+        return 1;
+    }
+
+    return CTimerLockerManager::GetInstance().GetLoadHistogram(lockers, window, histogram);
+}
+
+int RepeatWorkProc::SetMaxBacklog(int max_backlog)
+{
+    if (max_backlog < 0)
+        return 1;
+
+    m_max_backlog = max_backlog;
+    return 0;
+}
+
+int RepeatWorkProc::GetBacklogStats(BacklogStats& stats)
+{
+    stats.depth     = m_backlog_depth.load();
+    stats.max_depth = m_backlog_max_depth.load();
+    stats.coalesced = m_backlog_coalesced.load();
+    stats.deferred  = m_backlog_deferred.load();
+    stats.stolen    = m_backlog_stolen.load();
+    return 0;
+}
+
+int RepeatWorkProc::GetWorkStats(int work_type, TimerStats& stats)
+{
+    std::shared_ptr<CTimerStats> work_stats;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_queue_repeat_mutex);
+        WorkItem* item = FindWork(work_type);
+        if (nullptr == item)
+            return 1;
+        work_stats = item->stats;
+    }
+    if (nullptr == work_stats)
         return 2;
 
+    work_stats->GetStats(stats);
+    return 0;
+}
+
+int RepeatWorkProc::SetWorkSlack(int work_type, std::chrono::nanoseconds slack)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_queue_repeat_mutex);
+    WorkItem* item = FindWork(work_type);
+    if (nullptr == item)
+        return 1;
+
     CTimerLockerManager& timer_manager = CTimerLockerManager::GetInstance();
-    timer_manager.DeleteTimerLocker(it_timer->second);
-    m_map_timer.erase(it_timer);
+    if (false == timer_manager.SetTimerLockerSlack(item->timer, slack))
+        return 2;
+
+    return 0;
+}
+
+int RepeatWorkProc::DeleteWork(int work_type)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_queue_repeat_mutex);
+    WorkItem* item = FindWork(work_type);
+    if (nullptr == item)
+        return 1;
+
+    FreeWork(*item);
 
+    return 0;
+}
+
+int RepeatWorkProc::RunAfter(TaskId& id, std::chrono::nanoseconds delay, const RepeatWork& work)
+{
+    CTimerLockerManager& timer_manager = CTimerLockerManager::GetInstance();
+    return RunAt(id, timer_manager.GetTime() + delay, work);
+}
+
+int RepeatWorkProc::RunAt(TaskId& id, std::chrono::steady_clock::time_point deadline, const RepeatWork& work)
+{
+    CTimerLockerManager& timer_manager = CTimerLockerManager::GetInstance();
+
+    std::lock_guard<std::recursive_mutex> lock(m_queue_repeat_mutex);
+
+    TaskId task_id = ++m_task_id;
+    RepeatTask& task = m_map_task[task_id];
+    task.work = work;
+
+    auto func = [this, task_id](const CTimerLocker&) {
+        WorkerJob job;
+        job.is_task = true;
+        job.task_id = task_id;
+
+        PushJob(-1, job);
+    };
+
+    if (timer_manager.AddTimerTask(task.timer_task_id, deadline, func))
     {
-        std::lock_guard<std::recursive_mutex> lock(m_queue_repeat_mutex);
-        m_map_work.erase(it_work);
+        m_map_task.erase(task_id);
+        return 1;
     }
 
+    id = task_id;
+
+    return 0;
+}
+
+int RepeatWorkProc::CancelTask(TaskId id)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_queue_repeat_mutex);
+
+    auto it_task = m_map_task.find(id);
+    if (it_task == m_map_task.end())
+        return 1;
+
+    CTimerLockerManager& timer_manager = CTimerLockerManager::GetInstance();
+    timer_manager.DeleteTimerTask(it_task->second.timer_task_id);
+    m_map_task.erase(it_task);
+
     return 0;
 }
 
 void RepeatWorkProc::ThreadLoop()
 {
-    m_thread_running = true;
+    WorkerLoop(0);
+}
+
+void RepeatWorkProc::PushJob(int index, const WorkerJob& job)
+{
+    // affinity 가 없으면 worker 들에게 돌아가며 나누어 준다.
+    int worker_count = (int)m_worker_queues.size();
+    if (index < 0 || index >= worker_count)
+        index = (int)(m_next_worker.fetch_add(1, std::memory_order_relaxed) % worker_count);
+
+    long long depth     = ++m_backlog_depth;
+    long long max_depth = m_backlog_max_depth.load();
+    while (depth > max_depth && false == m_backlog_max_depth.compare_exchange_weak(max_depth, depth))
+        ;
+
+    CWorkerQueue& queue = *m_worker_queues[index];
+    WorkerJob* queue_job = queue.AllocJob();
+    *queue_job = job;
+    queue_job->enqueue_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    queue.Push(queue_job);
+    queue.m_pending = true;
+    m_batch_pending = true;
+}
+
+RepeatWorkProc::WorkerJob* RepeatWorkProc::NextJob(int index)
+{
+    CWorkerQueue& queue = *m_worker_queues[index];
+
+    // inbox 의 job 을 자신의 deque 로 옮긴 후에 가장 최근 job 부터 (LIFO) 꺼내어 cache 에 남아 있는 Work 를 먼저 실행 한다.
+    // Work 마다 대기 job 이 하나 뿐이라서 실행 후 다시 들어온 Work 가 계속 bottom 에 있으면 top 의 job 이 굶게 되므로
+    // top 의 job 이 최소 해상도 (Work 주기의 최소값) 이상 기다렸으면 그 job 을 먼저 꺼낸다.
+    // 여유가 있을 때는 LIFO 로, 밀려 있을 때는 오래된 순서 (FIFO) 로 처리 된다.
+    bool inbox_left = queue.MoveToDeque();
+
+    WorkerJob* job = nullptr;
+    long long oldest = queue.m_deque.GetTopStamp();
+    if (oldest >= 0)
+    {
+        long long now_ns  = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        long long wait_ns = CTimerLockerManager::GetInstance().GetTimerMinResolutionNs().count();
+        if (now_ns - oldest >= wait_ns)
+            job = queue.m_deque.Steal();
+    }
+    if (nullptr == job)
+        job = queue.m_deque.Pop();
+    if (job)
+    {
+        // 남은 job 이 있으면 쉬는 worker 를 깨워서 가져가게 한다.
+        if (inbox_left || false == queue.m_deque.Empty())
+            WakeIdleWorker(index);
+        return job;
+    }
+
+    // 자신의 queue 가 비어 있으면 다른 worker 의 deque 에서 가장 오래된 job 을, 없으면 inbox 에서 가져온다.
+    int worker_count = (int)m_worker_queues.size();
+    for (int offset = 1; offset < worker_count; offset++)
+    {
+        CWorkerQueue& victim = *m_worker_queues[(index + offset) % worker_count];
+        job = victim.m_deque.Steal();
+        if (nullptr == job)
+            job = victim.StealInbox();
+        if (job)
+        {
+            m_backlog_stolen++;
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+void RepeatWorkProc::WakeIdleWorker(int except)
+{
+    unsigned long long idle = m_idle_workers.load();
+    while (true)
+    {
+        unsigned long long candidates = idle & ~(1ULL << except);
+        if (0 == candidates)
+            return;
+
+        int index = 0;
+        while (0 == (candidates & (1ULL << index)))
+            index++;
+
+        // 같은 worker 를 여러 번 깨우지 않도록 bit 를 지운 쪽만 깨운다.
+        unsigned long long bit = 1ULL << index;
+        idle = m_idle_workers.fetch_and(~bit);
+        if (idle & bit)
+        {
+            m_worker_queues[index]->m_event.WakeUp();
+            return;
+        }
+    }
+}
+
+void RepeatWorkProc::WorkerLoop(int index)
+{
+    CWorkerQueue& queue = *m_worker_queues[index];
+    unsigned long long bit = 1ULL << index;
+
     while (true)
     {
-        m_queue_repeat_event.Wait();
+        m_idle_workers.fetch_or(bit);
+        queue.m_event.Wait();
+        m_idle_workers.fetch_and(~bit);
         if (false == m_thread_running)
             break;
 
-        std::lock_guard<std::recursive_mutex> lock(m_queue_repeat_mutex);
-        while (m_queue_repeat_work.size())
+        while (m_thread_running)
         {
-            int work_type = m_queue_repeat_work.front();
-            m_queue_repeat_work.pop();
-
-            auto it = m_map_work.find(work_type);
-            if (it == m_map_work.end())
-                continue;
+            WorkerJob* job = NextJob(index);
+            if (nullptr == job)
+                break;
+            m_backlog_depth--;
 
-            RepeatWork& func = it->second;
-            if (func)
-                func();
+            if (job->is_task)
+                RunTask(job->task_id);
+            else
+                RunWork(index, job->event);
+            queue.FreeJob(job);
         }
     }
 }
 
+void RepeatWorkProc::RunWork(int index, const RepeatEvent& event)
+{
+    // job 이 WorkDispatch 를 가지고 있으므로 m_queue_repeat_mutex 로 handle 을 찾지 않는다.
+    WorkDispatch* dispatch = event.dispatch.get();
+    if (nullptr == dispatch || dispatch->deleted.load())    // 삭제된 Work
+        return;
+
+    const RepeatWorkEx&                 func   = dispatch->work;
+    const std::shared_ptr<CTimerStats>& stats  = dispatch->stats;
+    OverrunPolicy                       policy = dispatch->policy;
+    dispatch->affinity.store(index, std::memory_order_relaxed);
+
+    // Work 는 lock 없이 실행하여 실행 중에도 AddWork(), DeleteWork() 와 다른 worker 가 막히지 않게 한다.
+    std::chrono::steady_clock::time_point deadline(std::chrono::steady_clock::duration(dispatch->deadline.load()));
+    int count = dispatch->count.exchange(0);
+    int ticks = dispatch->ticks.exchange(0);
+
+    // BURST 는 한번에 하나씩 실행하고 남은 event 는 다시 queue 에 넣어 다른 Work 와 번갈아 실행 한다.
+    int tick_count = OVERRUN_COALESCE == policy ? ticks : 1;
+    if (OVERRUN_BURST == policy && count > 1)
+        dispatch->count += count - 1;
+
+    if (count > 0)
+    {
+        if (stats)
+            stats->Record(CTimerLockerManager::GetInstance().GetTime(), deadline);
+        if (func)
+            func(tick_count);
+    }
+
+    dispatch->queued = false;
+    if (0 == dispatch->count.load())
+        return;
+    if (dispatch->queued.exchange(true))    // Timer callback 이 이미 새 job 을 넣었다.
+        return;
+
+    // 실행 중에 도착한 event 는 다른 Work 가 굶지 않도록 queue 뒤에 다시 넣는다.
+    WorkerJob job;
+    job.event = event;
+    PushJob(index, job);
+}
+
+void RepeatWorkProc::RunTask(TaskId task_id)
+{
+    RepeatWork func;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_queue_repeat_mutex);
+        auto it = m_map_task.find(task_id);
+        if (it == m_map_task.end())     // 취소된 task
+            return;
+
+        func = std::move(it->second.work);
+        m_map_task.erase(it);
+    }
+
+    if (func)
+        func();
+}
+
 int TestRepeatWorkProc()
 {
     RepeatWorkProc& repeat_work = RepeatWorkProc::GetInstance();
@@ -152,4 +1039,283 @@ int TestRepeatWorkProc()
     repeat_work.Deactivate();
 
     return 0;
-}
\ No newline at end of file
+}
+
+int BenchRepeatWorkSteal()
+{
+    enum
+    {
+        WORK_COUNT  = 64,
+        HEAVY_EVERY = 16,   // 16개 중 1개는 무거운 Work
+        PERIOD_MS   = 10,  // 기본 최소 해상도
+    };
+    const std::chrono::microseconds light_cost(20);
+    const std::chrono::microseconds heavy_cost(2000);
+
+    RepeatWorkProc& repeat_work = RepeatWorkProc::GetInstance();
+
+    int max_workers = (int)std::min(8u, std::max(2u, std::thread::hardware_concurrency()));
+    const int worker_counts[] = { 1, max_workers };
+
+    printf("%8s %12s %12s %12s %12s %10s\n", "workers", "calls/s", "p50(us)", "p99(us)", "max(us)", "stolen(%)");
+    for (int worker_count : worker_counts)
+    {
+        if (repeat_work.SetWorkerCount(worker_count) || repeat_work.Activate())
+            return 1;
+
+        RepeatWorkProc::BacklogStats begin_stats;
+        repeat_work.GetBacklogStats(begin_stats);
+
+        std::atomic<long long> calls{ 0 };
+        for (int work_type = 0; work_type < WORK_COUNT; work_type++)
+        {
+            std::chrono::microseconds cost = 0 == work_type % HEAVY_EVERY ? heavy_cost : light_cost;
+            auto func = [&calls, cost](int) {
+                // sleep 은 CPU 를 쓰지 않으므로 busy wait 로 비용을 만든다.
+                std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + cost;
+                while (std::chrono::steady_clock::now() < end)
+                    ;
+                calls++;
+            };
+            repeat_work.AddWork(work_type, std::chrono::milliseconds(PERIOD_MS), func, RepeatWorkProc::OVERRUN_COALESCE);
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::seconds(2));
+
+        // dispatch 지연은 Timer deadline 부터 Work 가 실행되기 시작한 시간까지 이다.
+        long long p50 = 0, p99 = 0, max = 0;
+        for (int work_type = 0; work_type < WORK_COUNT; work_type++)
+        {
+            TimerStats stats;
+            if (repeat_work.GetWorkStats(work_type, stats))
+                continue;
+            p50 = std::max(p50, stats.lateness.p50);
+            p99 = std::max(p99, stats.lateness.p99);
+            max = std::max(max, stats.lateness.max);
+        }
+
+        for (int work_type = 0; work_type < WORK_COUNT; work_type++)
+            repeat_work.DeleteWork(work_type);
+        repeat_work.Deactivate();
+
+        // 무거운 Work 가 자신의 worker 를 잡고 있는 동안 뒤에 쌓인 job 을 다른 worker 가 가져간 비율이다.
+        RepeatWorkProc::BacklogStats end_stats;
+        repeat_work.GetBacklogStats(end_stats);
+        long long stolen = end_stats.stolen - begin_stats.stolen;
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%8d %12.0f %12.1f %12.1f %12.1f %10.1f\n", worker_count, calls / seconds, p50 / 1000.0, p99 / 1000.0, max / 1000.0,
+               calls ? 100.0 * stolen / calls : 0.0);
+    }
+
+    repeat_work.SetWorkerCount(1);
+
+    return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+///  @brief : Producer thread 들이 넣은 시간을 consumer 가 꺼내어 enqueue 부터 dequeue 까지의 지연을 기록 한다.
+///           push(value) 가 실패하면 다시 시도하고, pop(values, max) 는 꺼낸 수를 리턴 한다.
+
+template <typename Push, typename Pop>
+static void BenchQueueLatency(const char* name, int producer_count, int push_count, Push push, Pop pop)
+{
+    typedef std::chrono::steady_clock chrono_clock;
+
+    CTimerHistogram latency;
+    std::atomic<int> ready{ 0 };
+    std::vector<std::thread> producers;
+
+    chrono_clock::time_point start = chrono_clock::now();
+    for (int producer = 0; producer < producer_count; producer++)
+    {
+        producers.emplace_back([&]() {
+            ready++;
+            for (int count = 0; count < push_count; count++)
+            {
+                while (false == push(chrono_clock::now().time_since_epoch().count()))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    long long values[64];
+    long long total = (long long)producer_count * push_count;
+    for (long long received = 0; received < total;)
+    {
+        size_t count = pop(values, 64);
+        if (0 == count)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        long long now = chrono_clock::now().time_since_epoch().count();
+        for (size_t index = 0; index < count; index++)
+            latency.Record(now - values[index]);
+        received += count;
+    }
+
+    for (std::thread& producer : producers)
+        producer.join();
+
+    double seconds = std::chrono::duration<double>(chrono_clock::now() - start).count();
+
+    TimerHistogramSnapshot snapshot;
+    latency.GetSnapshot(snapshot);
+    printf("%-28s %12.0f %12.1f %12.1f %12.1f\n", name, total / seconds, snapshot.p50 / 1000.0, snapshot.p99 / 1000.0, snapshot.max / 1000.0);
+}
+
+int BenchRepeatWorkQueue()
+{
+    enum
+    {
+        PRODUCER_COUNT = 2,
+        PUSH_COUNT     = 200000,
+    };
+
+    printf("%-28s %12s %12s %12s %12s\n", "queue", "items/s", "p50(us)", "p99(us)", "max(us)");
+
+    // 이전 구현과 같은 recursive_mutex + std::queue, 한번에 하나씩 꺼낸다.
+    {
+        std::recursive_mutex  mutex;
+        std::queue<long long> queue;
+        auto push = [&](long long value) {
+            std::lock_guard<std::recursive_mutex> lock(mutex);
+            queue.push(value);
+            return true;
+        };
+        auto pop = [&](long long* values, size_t) -> size_t {
+            std::lock_guard<std::recursive_mutex> lock(mutex);
+            if (queue.empty())
+                return 0;
+            values[0] = queue.front();
+            queue.pop();
+            return 1;
+        };
+        BenchQueueLatency("recursive_mutex+std::queue", PRODUCER_COUNT, PUSH_COUNT, push, pop);
+    }
+
+    {
+        CMpmcRing<long long> ring(1024);     // worker inbox 와 같은 크기
+        auto push = [&](long long value) {
+            return ring.TryPush(value);
+        };
+        auto pop = [&](long long* values, size_t max_count) -> size_t {
+            return ring.PopBatch(values, max_count);
+        };
+        BenchQueueLatency("CMpmcRing (batch pop)", PRODUCER_COUNT, PUSH_COUNT, push, pop);
+    }
+
+    return 0;
+}
+
+int BenchRepeatWorkRegistry()
+{
+    typedef std::chrono::steady_clock chrono_clock;
+    typedef std::chrono::duration<double, std::milli> chrono_duration_milli;
+
+    enum
+    {
+        WORK_COUNT   = 100000,
+        TICK_COUNT   = 10,
+        LOOKUP_COUNT = 1000000,
+    };
+    const std::chrono::milliseconds period(100);
+
+    if (timer_ex::InitializeVirtualTimer())
+    {
+        printf("Virtual timer 로 초기화 할 수 없습니다. 다른 Timer 를 사용하기 전에 호출 해야 합니다.\n");
+        return 1;
+    }
+
+    RepeatWorkProc& repeat_work = RepeatWorkProc::GetInstance();
+    if (repeat_work.Activate())
+        return 2;
+
+    std::atomic<long long> calls{ 0 };
+    auto func = [&calls]() {
+        calls++;
+    };
+
+    chrono_clock::time_point start = chrono_clock::now();
+    for (int work_type = 0; work_type < WORK_COUNT; work_type++)
+    {
+        if (repeat_work.AddWork(work_type, period, func))
+            return 3;
+    }
+    chrono_clock::time_point added = chrono_clock::now();
+
+    // 가상 시간을 한 주기씩 진행하고 모든 Work 가 호출 될 때까지 기다린다.
+    for (int tick = 1; tick <= TICK_COUNT; tick++)
+    {
+        timer_ex::AdvanceVirtualTimer(period);
+        while (calls < (long long)tick * WORK_COUNT)
+            std::this_thread::yield();
+    }
+    chrono_clock::time_point dispatched = chrono_clock::now();
+
+    for (int work_type = 0; work_type < WORK_COUNT; work_type++)
+        repeat_work.DeleteWork(work_type);
+    chrono_clock::time_point deleted = chrono_clock::now();
+
+    repeat_work.Deactivate();
+
+    printf("%d works\n", (int)WORK_COUNT);
+    printf("  AddWork    : %10.1f ms (%6.2f us/work)\n", chrono_duration_milli(added - start).count(), chrono_duration_milli(added - start).count() * 1000 / WORK_COUNT);
+    printf("  dispatch   : %10.1f ms (%6.2f us/call, %d ticks)\n", chrono_duration_milli(dispatched - added).count(), chrono_duration_milli(dispatched - added).count() * 1000 / ((double)WORK_COUNT * TICK_COUNT), (int)TICK_COUNT);
+    printf("  DeleteWork : %10.1f ms (%6.2f us/work)\n", chrono_duration_milli(deleted - dispatched).count(), chrono_duration_milli(deleted - dispatched).count() * 1000 / WORK_COUNT);
+
+    // dispatch 경로에서 Work 를 찾는 비용을 이전의 std::map<int, ...> 와 비교 한다.
+    struct Record
+    {
+        unsigned int                    generation = 0;
+        bool                            used = false;
+        std::function<void(int)>        work;
+        std::shared_ptr<CTimerStats>    stats;
+    };
+
+    std::map<int, Record>       record_map;
+    std::vector<Record>         record_slots(WORK_COUNT);
+    std::vector<unsigned long long> handles(WORK_COUNT);
+    for (int work_type = 0; work_type < WORK_COUNT; work_type++)
+    {
+        record_map[work_type].used   = true;
+        record_slots[work_type].used = true;
+        handles[work_type] = work_type;
+    }
+
+    // 실제 Timer 와 비슷하게 순서가 섞인 work_type 으로 찾는다.
+    std::vector<int> order(LOOKUP_COUNT);
+    unsigned int seed = 12345;
+    for (int& work_type : order)
+    {
+        seed = seed * 1103515245 + 12345;
+        work_type = (int)((seed >> 8) % WORK_COUNT);
+    }
+
+    long long found = 0;
+    start = chrono_clock::now();
+    for (int work_type : order)
+    {
+        auto it = record_map.find(work_type);
+        if (it != record_map.end() && it->second.used)
+            found++;
+    }
+    double map_ns = std::chrono::duration<double, std::nano>(chrono_clock::now() - start).count() / LOOKUP_COUNT;
+
+    start = chrono_clock::now();
+    for (int work_type : order)
+    {
+        unsigned long long handle = handles[work_type];
+        const Record& record = record_slots[handle & 0xFFFFFFFF];
+        if (record.used && record.generation == (unsigned int)(handle >> 32))
+            found++;
+    }
+    double slot_ns = std::chrono::duration<double, std::nano>(chrono_clock::now() - start).count() / LOOKUP_COUNT;
+
+    printf("  lookup     : std::map %.1f ns, slot map %.1f ns (found %lld)\n", map_ns, slot_ns, found);
+
+    return 0;
+}
@@ -7,12 +7,16 @@
 
 
 #include <mutex>
-#include <queue>
-#include <map>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <unordered_map>
 #include <functional>
 
 #include "InnerThread.h"
 #include "Locker.h"
+#include "TimerStats.h"
 
 class CTimerLocker;
 
@@ -22,15 +26,88 @@ class CTimerLocker;
 
 class RepeatWorkProc : public InnerThread
 {
+public:
+    using TaskId = long long;
+
+    ///  @brief   시스템 지연으로 Work 의 주기를 놓친 경우의 처리 방법
+    enum OverrunPolicy
+    {
+        OVERRUN_SKIP     = 0,   // 누락된 주기는 건너뛰고 한번만 호출 한다.
+        OVERRUN_BURST    = 1,   // 누락된 주기만큼 연속으로 호출 한다.
+        OVERRUN_COALESCE = 2,   // 한번만 호출하고 경과된 주기 수를 전달 한다.
+    };
+
+    ///  @brief   Work event queue 의 대기 상태
+    struct BacklogStats
+    {
+        long long   depth     = 0;  // 현재 queue 에서 대기 중인 job 수
+        long long   max_depth = 0;  // 가장 많이 대기 했던 job 수
+        long long   coalesced = 0;  // 이미 대기 중이거나 실행 중인 Work 에 합쳐진 Timer event 수
+        long long   deferred  = 0;  // 대기 job 수가 제한에 걸려 다음 주기로 미뤄진 Timer event 수
+        long long   stolen    = 0;  // 쉬는 worker 가 다른 worker 의 deque, inbox 에서 가져가 실행한 job 수
+    };
+
 private:
-    using RepeatWork = std::function<void()>;
+    struct WorkDispatch;
+
+    using RepeatWork   = std::function<void()>;
+    using RepeatWorkEx = std::function<void(int tick_count)>;   // tick_count : 지난 호출 이후 경과된 주기 수
 
-    bool                            m_thread_running = false;
-    Locker                          m_queue_repeat_event;
-    std::recursive_mutex            m_queue_repeat_mutex;
-    std::queue<int>                 m_queue_repeat_work;
-    std::map<int, CTimerLocker*>    m_map_timer;
-    std::map<int, RepeatWork>       m_map_work;
+    using WorkHandle = unsigned long long;  // 하위 32 bit 는 m_work_slots 의 index, 상위 32 bit 는 slot 의 generation
+
+    ///  @brief   m_work_slots 에 연속으로 저장되는 Work 의 정보
+    struct WorkItem
+    {
+        int             work_type  = 0;
+        unsigned int    generation = 0;     // slot 이 재사용 될 때마다 증가하여 삭제된 Work 의 handle 을 구분 한다.
+        bool            used       = false;
+        CTimerLocker*   timer      = nullptr;
+        RepeatWorkEx    work;
+        OverrunPolicy   policy = OVERRUN_SKIP;
+        long long       period = 0;     // 주기 (nanosecond)
+        long long       phase  = -1;    // 위상 (nanosecond), 위상을 지정하지 않았으면 -1
+        std::shared_ptr<CTimerStats>    stats;  // Work 가 실행된 간격, deadline 대비 지연
+        std::shared_ptr<WorkDispatch>   dispatch;   // Timer callback 과 worker 가 공유하는 대기 상태
+    };
+
+    struct RepeatEvent
+    {
+        std::shared_ptr<WorkDispatch>   dispatch;   // 실행할 Work 의 상태, Work 가 삭제되어도 job 이 남아 있는 동안 유지된다.
+    };
+
+    struct RepeatTask
+    {
+        long long   timer_task_id = 0;      // CTimerLockerManager 의 Timer task 식별자
+        RepeatWork  work;
+    };
+
+    class CWorkerThread;
+    class CWorkerQueue;
+    struct WorkerJob;
+
+    std::atomic<bool>               m_thread_running{ false };
+    int                             m_worker_count = 1;         // ThreadLoop 를 포함한 worker thread 수
+    std::vector<std::unique_ptr<CWorkerThread>> m_workers;      // 추가 worker thread
+    std::vector<std::unique_ptr<CWorkerQueue>>  m_worker_queues;    // worker 별 inbox 와 work-stealing deque
+    std::atomic<unsigned long long> m_idle_workers{ 0 };        // 대기 중인 worker 의 bit mask
+    std::atomic<unsigned int>       m_next_worker{ 0 };         // affinity 가 없는 event 를 나누어 줄 다음 worker
+    std::atomic<bool>               m_batch_pending{ false };   // Timer batch 에서 추가된 Work 가 있는지 여부
+    int                             m_batch_callback_id = 0;
+    bool                            m_phase_stagger = false;    // 같은 주기의 Work 들의 위상을 분산 시킬지 여부
+    std::recursive_mutex            m_queue_repeat_mutex;       // m_work_slots, m_map_task 보호
+    std::vector<WorkItem>           m_work_slots;               // generational slot map
+    std::vector<unsigned int>       m_free_work_slots;
+    std::unordered_map<int, WorkHandle> m_work_handles;         // work_type 별 handle
+
+    std::atomic<int>                m_max_backlog{ 0 };         // 대기 job 수 제한, 0 이면 제한 없음
+    std::atomic<long long>          m_backlog_depth{ 0 };
+    std::atomic<long long>          m_backlog_max_depth{ 0 };
+    std::atomic<long long>          m_backlog_coalesced{ 0 };
+    std::atomic<long long>          m_backlog_deferred{ 0 };
+    std::atomic<long long>          m_backlog_stolen{ 0 };
+
+    TaskId                                  m_task_id = 0;
+    std::unordered_map<TaskId, RepeatTask>  m_map_task;     // 한번만 호출되는 Work
 
 private:
     RepeatWorkProc();
@@ -38,7 +115,18 @@ private:
 
     virtual void ThreadLoop() override;
 
+    void        WorkerLoop(int index);
+    void        PushJob(int index, const WorkerJob& job);
+    WorkerJob*  NextJob(int index);
+    void        WakeIdleWorker(int except);
+    void        RunWork(int index, const RepeatEvent& event);
+    void        RunTask(TaskId task_id);
+
     std::string GetTimerName(int work_type) const;
+    WorkItem*   FindWork(WorkHandle handle);
+    WorkItem*   FindWork(int work_type);
+    void        FreeWork(WorkItem& item);
+    long long   SelectPhase(long long period) const;
 
 public:
     ///  @brief      싱글턴 패턴으로 구현되어 있다.
@@ -54,6 +142,16 @@ public:
     int  Activate();
     int  Deactivate();
 
+    ///  @brief : Work 를 실행하는 worker thread 수를 설정 한다. Activate(), AddWork() 전에 호출 한다.
+    ///           서로 다른 Work 는 병렬로 실행되지만 같은 Work 는 동시에 실행되지 않는다.
+    ///           실행 중에 도착한 주기는 합쳐 두었다가 실행이 끝난 후 다시 queue 에 넣는다. SetMaxBacklog() 참조
+    ///           Work 는 마지막으로 실행한 worker 의 deque 로 보내지며 그 worker 는 최근 job 부터 실행하고
+    ///           쉬는 worker 는 다른 worker 의 deque 에서 가장 오래된 job 을 가져간다.
+    ///  @param count[in] : worker thread 수 (1 ~ 64), 기본값은 1
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+    int  SetWorkerCount(int count);
+    int  GetWorkerCount() const { return m_worker_count; }
+
     ///  @brief : 식별자를 통해 일정 주기마다 호출되는 콜백 함수를 등록 한다.
     ///  @param work_type[in] : Work 의 식별자
     ///  @param ms[in] : 시간을 설정 (millisecond)
@@ -61,10 +159,99 @@ public:
     ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
     int  AddWork(int work_type, int ms, const RepeatWork& work);
 
+    ///  @brief : 식별자를 통해 일정 주기마다 호출되는 콜백 함수를 등록 한다.
+    ///           1 ms 미만의 주기는 CTimerLockerManager::SetTimerMinResolution() 으로 해상도를 낮춘 후에 사용 한다.
+    ///  @param work_type[in] : Work 의 식별자
+    ///  @param period[in] : 시간을 설정 (nanosecond)
+    ///  @param work[in] : period 시간 마다 호출되는 Work 콜백 함수
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+    int  AddWork(int work_type, std::chrono::nanoseconds period, const RepeatWork& work);
+
+    ///  @brief : 식별자를 통해 일정 주기마다 호출되는 콜백 함수를 등록 한다.
+    ///           시스템 지연으로 주기를 놓친 경우 policy 에 따라 호출 된다.
+    ///  @param work_type[in] : Work 의 식별자
+    ///  @param period[in] : 시간을 설정 (nanosecond)
+    ///  @param work[in] : period 시간 마다 호출되는 Work 콜백 함수, tick_count 로 경과된 주기 수를 전달 받는다.
+    ///                    OVERRUN_COALESCE 가 아니면 tick_count 는 항상 1 이다.
+    ///  @param policy[in] : 주기를 놓친 경우의 처리 방법
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+    int  AddWork(int work_type, std::chrono::nanoseconds period, const RepeatWorkEx& work, OverrunPolicy policy = OVERRUN_COALESCE);
+
+    ///  @brief : Work 의 slack 을 설정 한다. 주기마다 slack 시간 만큼 늦게 호출되는 것을 허용하며
+    ///           그 범위 안에서 다른 Work 와 같은 Timer tick 으로 묶어서 한번에 처리 한다.
+    ///  @param work_type[in] : AddWork() 에서 사용한 Work 의 식별자
+    ///  @param slack[in] : 허용하는 지연 시간
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+    int  SetWorkSlack(int work_type, std::chrono::nanoseconds slack);
+
+    ///  @brief : 이후에 AddWork() 로 추가되는 Work 들을 같은 주기의 Work 들과 서로 다른 위상 (phase) 으로 배치 한다.
+    ///           같은 주기의 Work 들이 한 tick 에 몰리지 않게 되지만 첫 호출이 최대 1 주기 늦어질 수 있다.
+    ///  @param enable[in] : 위상 분산 여부, 기본값은 false
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+    int  SetPhaseStagger(bool enable);
+
+    ///  @brief : 다음 호출 부터 window 시간 동안 Timer tick 별로 호출되는 Work 의 수를 구한다.
+    ///           CTimerLockerManager::GetLoadHistogram() 참조
+    ///  @param window[in] : 집계하는 시간 범위, 주로 Work 들의 주기를 사용 한다.
+    ///  @param histogram[out] : tick 별 Work 호출 수
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+    int  GetLoadHistogram(std::chrono::nanoseconds window, std::vector<int>& histogram);
+
+    ///  @brief : Work 가 실제로 실행된 간격, Timer deadline 대비 실행 지연 histogram 과 실제 FPS 를 반환 한다.
+    ///           지연에는 Timer 오차와 RepeatWorkProc thread 에서 대기한 시간이 모두 포함 된다.
+    ///  @param work_type[in] : AddWork() 에서 사용한 Work 의 식별자
+    ///  @param stats[out] : 통계
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+    int  GetWorkStats(int work_type, TimerStats& stats);
+
+    ///  @brief : Work 마다 대기 중인 job 은 최대 1개이며, 대기 중이거나 실행 중에 도착한 Timer event 는 그 job 에 합쳐진다.
+    ///           합쳐진 event 는 OverrunPolicy 에 따라 SKIP 은 한번, COALESCE 는 tick_count 합으로 한번, BURST 는 event 수 만큼 호출 된다.
+    ///           대기 job 수가 max_backlog 에 도달하면 새로 대기해야 하는 Work 의 event 는 tick 만 누적되고 다음 주기로 미뤄진다.
+    ///           RunAfter(), RunAt() 의 task 는 제한 받지 않는다.
+    ///  @param max_backlog[in] : 대기 job 수 제한, 0 이면 제한 없음 (기본값)
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+    int  SetMaxBacklog(int max_backlog);
+
+    ///  @brief : Work event queue 의 대기 상태를 반환 한다.
+    ///  @param stats[out] : 대기 job 수, 합쳐지거나 미뤄진 Timer event 수, 다른 worker 가 가져간 job 수
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+    int  GetBacklogStats(BacklogStats& stats);
+
     ///  @brief : work_type 식별자를 통해 일정 주기마다 호출되는 콜백 함수를 제거 한다.
     ///  @param work_type[in] : AddWork() 에서 사용한 Work 의 식별자
     ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
     int  DeleteWork(int work_type);
+
+    ///  @brief : delay 시간 후에 한번만 호출되는 콜백 함수를 등록 한다.
+    ///           Timer 를 공유하기 때문에 task 마다 OS Timer 를 생성하지 않는다.
+    ///  @param id[out] : CancelTask() 에서 사용할 task 식별자
+    ///  @param delay[in] : 호출 될 때까지의 시간
+    ///  @param work[in] : 호출되는 Work 콜백 함수
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+    int  RunAfter(TaskId& id, std::chrono::nanoseconds delay, const RepeatWork& work);
+
+    ///  @brief : deadline 시간에 한번만 호출되는 콜백 함수를 등록 한다.
+    ///  @param id[out] : CancelTask() 에서 사용할 task 식별자
+    ///  @param deadline[in] : 호출되는 시간, CTimerLockerManager::GetTime() 을 기준으로 한다.
+    ///  @param work[in] : 호출되는 Work 콜백 함수
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+    int  RunAt(TaskId& id, std::chrono::steady_clock::time_point deadline, const RepeatWork& work);
+
+    ///  @brief : 아직 호출되지 않은 task 를 취소 한다. O(1)
+    ///  @param id[in] : RunAfter(), RunAt() 에서 얻어온 task 식별자
+    ///  @return : 성공 시에 0, 이미 호출 되었거나 없는 task 이면 1
+    int  CancelTask(TaskId id);
 };
 
-int TestRepeatWorkProc();
\ No newline at end of file
+int TestRepeatWorkProc();
+
+///  @brief : 실행 비용이 불균형한 Work 들을 worker 1개와 여러 개로 실행하여 처리량과 dispatch 지연 (p50, p99),
+///           다른 worker 의 deque 에서 가져간 (steal) job 의 비율을 출력 한다.
+int BenchRepeatWorkSteal();
+
+///  @brief : Work event queue 의 enqueue 부터 dequeue 까지의 지연과 처리량을 이전의 recursive_mutex + std::queue 와 비교하여 출력 한다.
+int BenchRepeatWorkQueue();
+
+///  @brief : 가상 Timer 에서 100k 개의 Work 를 등록, 호출, 삭제하는 비용과 work_type 으로 std::map 을 찾는 비용,
+///           slot map 의 handle 로 찾는 비용을 비교하여 출력 한다. 다른 Timer 를 사용하기 전에 호출 해야 한다.
+int BenchRepeatWorkRegistry();
\ No newline at end of file
@@ -4,8 +4,15 @@
 #include "TimerEx.h"
 
 #include <vector>
+#include <deque>
+#include <queue>
 #include <memory>
 #include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <thread>
+#include <cstdio>
+#include <cstdint>
 
 #ifdef WIN32
 #ifndef _WINDOWS_
@@ -16,9 +23,14 @@
 #else
 #include <csignal>
 #include <ctime>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
 #include <unistd.h>
+#include <sys/timerfd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
-#include <thread>
 #include <mutex>
 #include <condition_variable>
 #endif
@@ -33,6 +45,17 @@ typedef MMRESULT TimerIdOs;
 typedef timer_t TimerIdOs;
 #endif // __linux
 
+#define ONE_MSEC_TO_NSEC (1000000)
+#define ONE_SEC_TO_NSEC  (1000000000)
+
+// TimerIdEx 구성 : [30 ~ 20 bit] slot 의 generation, [19 ~ 0 bit] slot 의 index
+// 삭제된 slot 이 재사용 되면 generation 이 증가하기 때문에 이전 id 로는 새 Timer 를 호출 할 수 없다.
+#define TIMER_ID_INDEX_BITS         (20)
+#define TIMER_ID_INDEX_MASK         ((1 << TIMER_ID_INDEX_BITS) - 1)
+#define TIMER_ID_GENERATION_MASK    (0x7FF)
+#define TIMER_SLOT_CHUNK_SIZE       (1024)
+#define TIMER_SLOT_MAX_CHUNKS       ((TIMER_ID_INDEX_MASK + 1) / TIMER_SLOT_CHUNK_SIZE)
+
 using namespace timer_ex;
 
 //////////////////////////////////////////////////////////////////////////
@@ -42,55 +65,269 @@ using namespace timer_ex;
 class CTimerImpl
 {
     friend class CTimerInstance;
+    friend int ::BenchTimerCallBack();
 
 public:
+    // CallBack 에서 참조하는 Timer 정보, 게시된 후에는 변경되지 않는다.
+    struct TimerRecord
+    {
+        TimerIdEx id    = -1;
+        TimerIdOs os_id = 0;
+#ifdef __linux
+        int       fd    = -1;       // LINUX_TIMERFD 에서 사용하는 timerfd
+#endif
+        void*     ptr   = nullptr;
+
+        std::function<void(TimerIdEx id, void* ptr, int expirations)> func;
+    };
+
     struct ParamTimer
     {
         TimerIdOs id   = 0;
-        int       ms   = 0;
+#ifdef __linux
+        int       fd   = -1;        // LINUX_TIMERFD 에서 사용하는 timerfd
+#endif
+        long long ns   = 0;         // 주기 (nanosecond)
+        long long first = 0;        // 첫 만료 시간 (GetTime() 기준 nanosecond), 0 이면 생성 시점 + ns
         void*     ptr  = nullptr;
         bool      used = false;
+        int       generation = 0;
 
-        std::function<void(TimerIdEx id, void* ptr)> func;
+        std::function<void(TimerIdEx id, void* ptr, int expirations)> func;
+
+        // 아래 두 값만 lock 없이 CallBack 에서 접근 한다.
+        std::atomic<TimerRecord*> record{ nullptr };    // 사용중인 Timer 의 정보, 삭제 되면 nullptr
+        std::atomic<int>          readers{ 0 };         // record 를 참조하고 있는 CallBack 의 수
+    };
+
+protected:
+    ///  @brief      CallBack 이 slot 의 record 를 참조하는 동안 readers 를 증가 시켜 record 가 해제되지 않도록 한다.
+    class CReadGuard
+    {
+    private:
+        ParamTimer& m_slot;
+
+    public:
+        explicit CReadGuard(ParamTimer& slot) : m_slot(slot)
+        {
+            m_slot.readers.fetch_add(1);
+        }
+        ~CReadGuard()
+        {
+            m_slot.readers.fetch_sub(1);
+        }
+    };
+
+    struct RetiredRecord
+    {
+        ParamTimer*                  slot = nullptr;
+        std::unique_ptr<TimerRecord> record;
     };
 
 protected:
-    static std::vector<ParamTimer> m_timers;
-    static std::recursive_mutex    m_mutex_timers;
+    // slot 은 chunk 단위로 증가하며 이미 할당된 chunk 는 이동하지 않는다.
+    // 따라서 Timer 가 추가 되더라도 CallBack 에서 참조하는 slot 의 주소는 변하지 않는다.
+    static std::unique_ptr<ParamTimer[]>    m_timers[TIMER_SLOT_MAX_CHUNKS];
+    static std::atomic<size_t>              m_timer_count;      // 할당된 slot 수
+    static std::deque<size_t>               m_free_timers;      // 재사용 가능한 slot 의 index (FIFO)
+    static std::vector<RetiredRecord>       m_retired_records;  // CallBack 이 참조 중이라 해제를 미룬 record
+    static std::recursive_mutex             m_mutex_timers;
 
 protected:
-    static void CallBack(TimerIdEx id)
+    static TimerIdEx MakeTimerId(size_t index, int generation)
+    {
+        return (TimerIdEx)(((generation & TIMER_ID_GENERATION_MASK) << TIMER_ID_INDEX_BITS) | (int)index);
+    }
+
+    static size_t GetTimerIndex(TimerIdEx id)
+    {
+        return (size_t)(id & TIMER_ID_INDEX_MASK);
+    }
+
+    static int GetTimerGeneration(TimerIdEx id)
+    {
+        return (id >> TIMER_ID_INDEX_BITS) & TIMER_ID_GENERATION_MASK;
+    }
+
+    static ParamTimer* GetSlot(size_t index)
+    {
+        if (m_timer_count.load(std::memory_order_acquire) <= index)
+            return nullptr;
+
+        return &m_timers[index / TIMER_SLOT_CHUNK_SIZE][index % TIMER_SLOT_CHUNK_SIZE];
+    }
+
+    ///  @brief      id 에 해당하는 사용중인 slot 을 반환 한다.
+    ///              삭제 되었거나 다른 Timer 로 재사용된 slot 이면 nullptr 을 반환 한다.
+    static ParamTimer* GetTimer(TimerIdEx id)
+    {
+        if (id < 0)
+            return nullptr;
+
+        ParamTimer* item = GetSlot(GetTimerIndex(id));
+        if (nullptr == item || false == item->used || item->generation != GetTimerGeneration(id))
+            return nullptr;
+
+        return item;
+    }
+
+    ///  @brief      id 에 해당하는 slot 을 반환 한다. CallBack 에서 lock 없이 사용 한다.
+    static ParamTimer* GetCallBackSlot(TimerIdEx id)
+    {
+        if (id < 0)
+            return nullptr;
+
+        return GetSlot(GetTimerIndex(id));
+    }
+
+    ///  @brief      CReadGuard 로 보호된 상태에서 id 의 record 를 읽는다.
+    ///              삭제 되었거나 다른 Timer 로 재사용된 slot 이면 nullptr 을 반환 한다.
+    static TimerRecord* ReadRecord(ParamTimer& slot, TimerIdEx id)
     {
-        //std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
+        TimerRecord* record = slot.record.load();
+        if (nullptr == record || record->id != id)
+            return nullptr;
 
-        ParamTimer& output = m_timers[(size_t)id];
-        if (output.used && output.func)
-            output.func(id, output.ptr);
+        return record;
     }
 
+    ///  @brief      lock 없이 Callback 함수를 호출 한다.
+    ///              DeleteTimer, CreateTimer 가 동시에 호출 되더라도 record 는 readers 가 0 이 될때까지 해제되지 않기 때문에 안전하다.
+    ///  @param expirations[in] : 마지막 Callback 이후에 만료된 횟수, 1 보다 크면 (expirations - 1) 번의 event 가 누락된 것이다.
+    static void CallBack(TimerIdEx id, int expirations = 1)
+    {
+        ParamTimer* slot = GetCallBackSlot(id);
+        if (nullptr == slot)
+            return;
+
+        CReadGuard guard(*slot);
+
+        TimerRecord* record = ReadRecord(*slot, id);
+        if (record && record->func)
+            record->func(id, record->ptr, expirations);
+    }
+
+    ///  @brief      GetReservedTimer() 로 설정한 slot 을 사용중으로 변경하고 CallBack 에서 참조할 record 를 게시 한다.
+    void PublishTimer(TimerIdEx id)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
+
+        ParamTimer& item = GetReservedTimer(id);
+
+        TimerRecord* record = new TimerRecord;
+        record->id    = id;
+        record->os_id = item.id;
+#ifdef __linux
+        record->fd    = item.fd;
+#endif
+        record->ptr   = item.ptr;
+        record->func  = item.func;
+
+        item.used = true;
+        item.record.store(record);
+    }
+
+    ///  @brief      record 를 게시 해제 한다. 참조 중인 CallBack 이 있으면 해제를 미룬다.
+    ///              record 를 먼저 교체한 후에 readers 를 확인하기 때문에 (둘 다 seq_cst)
+    ///              readers 가 0 이면 이후의 CallBack 은 이 record 를 볼 수 없다.
+    void RetireRecord(ParamTimer& item)
+    {
+        std::unique_ptr<TimerRecord> record(item.record.exchange(nullptr));
+        if (nullptr == record || 0 == item.readers.load())
+            return;
+
+        RetiredRecord retired;
+        retired.slot   = &item;
+        retired.record = std::move(record);
+        m_retired_records.push_back(std::move(retired));
+    }
+
+    ///  @brief      더 이상 참조 중인 CallBack 이 없는 record 들을 해제 한다.
+    void ReclaimRecords()
+    {
+        auto it = std::remove_if(m_retired_records.begin(), m_retired_records.end(), [](const RetiredRecord& retired) {
+            return 0 == retired.slot->readers.load();
+        });
+        m_retired_records.erase(it, m_retired_records.end());
+    }
+
+#ifdef __linux
+    ///  @brief      param 의 주기와 첫 만료 시간으로 itimerspec 을 설정 한다.
+    ///              first 가 설정되어 있으면 CLOCK_MONOTONIC 의 절대 시간이므로 ABSTIME flag 와 함께 사용 한다.
+    static void SetTimerSpec(struct itimerspec& its, const ParamTimer& param)
+    {
+        long long nano_value = param.first > 0 ? param.first : param.ns;
+        its.it_value.tv_sec = nano_value / ONE_SEC_TO_NSEC;
+        its.it_value.tv_nsec = nano_value % ONE_SEC_TO_NSEC;
+        its.it_interval.tv_sec = param.ns / ONE_SEC_TO_NSEC;
+        its.it_interval.tv_nsec = param.ns % ONE_SEC_TO_NSEC;
+    }
+#endif
+
+    ///  @brief      빈 slot 을 O(1) 로 예약하고 id 를 반환 한다.
+    ///              예약된 slot 은 GetReservedTimer() 로 설정한 후에 used 를 true 로 변경 한다.
+    ///  @return     성공 시에 id, 모든 slot 을 사용중이면 -1
     TimerIdEx CreateTimerId()
     {
-        int index = 0;
-        for (ParamTimer& item : m_timers)
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
+
+        ReclaimRecords();
+
+        size_t index = 0;
+        if (m_free_timers.size())
         {
-            if (false == item.used)
-                break;
-            index++;
+            index = m_free_timers.front();
+            m_free_timers.pop_front();
         }
+        else
+        {
+            index = m_timer_count.load(std::memory_order_relaxed);
+            if ((size_t)TIMER_ID_INDEX_MASK < index)
+                return -1;
+
+            std::unique_ptr<ParamTimer[]>& chunk = m_timers[index / TIMER_SLOT_CHUNK_SIZE];
+            if (nullptr == chunk)
+                chunk.reset(new ParamTimer[TIMER_SLOT_CHUNK_SIZE]);
 
-        return (TimerIdEx)index;
+            m_timer_count.store(index + 1, std::memory_order_release);
+        }
+
+        return MakeTimerId(index, GetSlot(index)->generation);
+    }
+
+    static ParamTimer& GetReservedTimer(TimerIdEx id)
+    {
+        return *GetSlot(GetTimerIndex(id));
+    }
+
+    ///  @brief      slot 을 반환 한다. generation 이 증가하기 때문에 기존 id 는 더 이상 유효하지 않다.
+    void ReleaseTimerId(TimerIdEx id)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
+
+        ParamTimer& item = GetReservedTimer(id);
+        RetireRecord(item);
+
+        item.used = false;
+        item.ptr  = nullptr;
+        item.func = nullptr;
+        item.generation = (item.generation + 1) & TIMER_ID_GENERATION_MASK;
+
+        m_free_timers.push_back(GetTimerIndex(id));
+
+        ReclaimRecords();
     }
 
     int DeleteTimerAll()
     {
         std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
 
-        int index = 0;
-        for (ParamTimer& item : m_timers)
+        size_t count = m_timer_count.load(std::memory_order_relaxed);
+        for (size_t index = 0; index < count; index++)
         {
-            if (item.used)
-                DeleteTimer((TimerIdEx)index);
-            index++;
+            ParamTimer* item = GetSlot(index);
+            if (item->used)
+                DeleteTimer(MakeTimerId(index, item->generation));
         }
 
         return 0;
@@ -107,11 +344,21 @@ public:
 
     virtual int Initialize() = 0;
     virtual int Finalize() = 0;
+
+    ///  @brief      Timer 가 사용하는 monotonic clock 의 현재 시간을 반환 한다.
+    virtual std::chrono::nanoseconds GetTime()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+    }
+
     virtual int CreateTimer(TimerIdEx& id, const ParamTimer& param) = 0;
     virtual int DeleteTimer(const TimerIdEx& id) = 0;
 };
 
-std::vector<CTimerImpl::ParamTimer> CTimerImpl::m_timers(64);
+std::unique_ptr<CTimerImpl::ParamTimer[]> CTimerImpl::m_timers[TIMER_SLOT_MAX_CHUNKS];
+std::atomic<size_t> CTimerImpl::m_timer_count(0);
+std::deque<size_t> CTimerImpl::m_free_timers;
+std::vector<CTimerImpl::RetiredRecord> CTimerImpl::m_retired_records;
 std::recursive_mutex CTimerImpl::m_mutex_timers;
 
 //////////////////////////////////////////////////////////////////////////
@@ -153,18 +400,29 @@ public:
         std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
 
         id = CreateTimerId();
+        if (-1 == id)
+            return 2;
+
+        // MMTimer 는 1 ms 단위만 지원 한다.
+        UINT ms = (UINT)((param.ns + ONE_MSEC_TO_NSEC / 2) / ONE_MSEC_TO_NSEC);
+        if (ms < 1)
+            ms = 1;
 
         timeBeginPeriod(1);
-        MMRESULT hTimer = timeSetEvent(param.ms, 1, CTimerWinmm::TimerCallback, (DWORD_PTR)id, TIME_PERIODIC);
+        MMRESULT hTimer = timeSetEvent(ms, 1, CTimerWinmm::TimerCallback, (DWORD_PTR)id, TIME_PERIODIC);
         if (NULL == hTimer)
+        {
+            timeEndPeriod(1);
+            ReleaseTimerId(id);
             return 1;
+        }
 
-        ParamTimer& item = m_timers[id];
+        ParamTimer& item = GetReservedTimer(id);
         item.id   = hTimer;
-        item.ms   = param.ms;
+        item.ns   = param.ns;
         item.func = param.func;
         item.ptr  = param.ptr;
-        item.used = true;
+        PublishTimer(id);
 
         return 0;
     }
@@ -173,17 +431,15 @@ public:
     {
         std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
 
-        size_t index = (size_t)id;
-        if (m_timers.size() <= index)
+        ParamTimer* item = GetTimer(id);
+        if (nullptr == item)
             return 1;
 
-        ParamTimer& item = m_timers[index];
-        item.used = false;
-        item.ptr  = nullptr;
-
-        timeKillEvent((MMRESULT)item.id);
+        timeKillEvent((MMRESULT)item->id);
         timeEndPeriod(1);
 
+        ReleaseTimerId(id);
+
         return 0;
     }
 };
@@ -197,8 +453,6 @@ public:
 
 //#define MY_TIMER_SIGNAL SIGRTMIN
 #define MY_TIMER_SIGNAL SIGVTALRM
-#define ONE_MSEC_TO_NSEC (1000000)
-#define ONE_SEC_TO_NSEC  (1000000000)
 typedef void(*sa_sigaction_ex)(int, siginfo_t*, void*);
 
 
@@ -227,7 +481,7 @@ private:
 
         while (true) {
             std::unique_lock<std::mutex> locker(m_mutex);
-            m_condition_variable.wait(locker);
+            m_cv.wait(locker);
 
             break;
         }
@@ -256,10 +510,24 @@ private:
         return 0;
     }
 
-    static void TimerCallback(int sig, siginfo_t* si, void* context)
+    static void TimerCallback(int, siginfo_t* si, void*)
     {
         int key = si->si_value.sival_int;
-        CallBack((TimerIdEx)key);
+
+        ParamTimer* slot = GetCallBackSlot((TimerIdEx)key);
+        if (nullptr == slot)
+            return;
+
+        CReadGuard guard(*slot);
+
+        TimerRecord* record = ReadRecord(*slot, (TimerIdEx)key);
+        if (nullptr == record || nullptr == record->func)
+            return;
+
+        // signal 이 처리되기 전에 만료된 횟수는 timer_getoverrun 으로 얻어온다.
+        int overrun = timer_getoverrun((timer_t)record->os_id);
+
+        record->func((TimerIdEx)key, record->ptr, 1 + (overrun > 0 ? overrun : 0));
     }
 public:
     CTimerLinuxSignal()
@@ -294,7 +562,7 @@ public:
     {
         DeleteTimerAll();
 
-        m_condition_variable.notify_one();
+        m_cv.notify_one();
 
         if (m_threadTimerSignal.joinable())
             m_threadTimerSignal.join();
@@ -304,13 +572,15 @@ public:
 
     virtual int CreateTimer(TimerIdEx& id, const ParamTimer& param) override
     {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
+
         TimerIdOs timerId = 0;
 
         // set up signal handler
         struct sigaction sa;
         memset(&sa, 0, sizeof(sa));
         sa.sa_flags = SA_SIGINFO;
-        sa.sa_sigaction = CTimerInstance::TimerCallback;
+        sa.sa_sigaction = CTimerLinuxSignal::TimerCallback;
         if (sigemptyset(&sa.sa_mask)) {
             return 1;
         }
@@ -319,6 +589,8 @@ public:
         }
 
         id = CreateTimerId();
+        if (-1 == id)
+            return 5;
 
         // create alarm
         struct sigevent sigEvt;
@@ -327,26 +599,24 @@ public:
         sigEvt.sigev_signo = MY_TIMER_SIGNAL;
         sigEvt.sigev_value.sival_int = id;
         //sigEvt.sigev_value.sival_ptr = this;
-        if (timer_create(CLOCK_REALTIME, &sigEvt, &timerId)) {
+        if (timer_create(CLOCK_MONOTONIC, &sigEvt, &timerId)) {
+            ReleaseTimerId(id);
             return 3;
         }
 
         // Save Timer Inforamtion
-        ParamTimer& item = m_timers[id];
+        ParamTimer& item = GetReservedTimer(id);
         item.id = timerId;
-        item.ms = param.ms;
+        item.ns = param.ns;
         item.func = param.func;
         item.ptr = param.ptr;
-        item.used = true;
+        PublishTimer(id);
 
         // set alarm
         struct itimerspec its;
-        long nano_intv = param.ms * ONE_MSEC_TO_NSEC;
-        its.it_value.tv_sec = nano_intv / ONE_SEC_TO_NSEC;
-        its.it_value.tv_nsec = nano_intv % ONE_SEC_TO_NSEC;
-        its.it_interval.tv_sec = its.it_value.tv_sec;
-        its.it_interval.tv_nsec = its.it_value.tv_nsec;
-        if (timer_settime(timerId, 0, &its, NULL)) {
+        SetTimerSpec(its, param);
+        if (timer_settime(timerId, param.first > 0 ? TIMER_ABSTIME : 0, &its, NULL)) {
+            DeleteTimer(id);
             return 4;
         }
 
@@ -355,20 +625,433 @@ public:
 
     virtual int DeleteTimer(const TimerIdEx& id) override
     {
-        size_t index = (size_t)id;
-        if (m_timers.size() <= index)
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
+
+        ParamTimer* item = GetTimer(id);
+        if (nullptr == item)
             return 1;
 
-        ParamTimer& item = m_timers[index];
+        timer_delete((timer_t)item->id);
+        ReleaseTimerId(id);
 
-        timer_delete((timer_t)item.id);
-        item.used = false;
+        return 0;
+    }
+};
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// class CTimerLinuxTimerFd
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __linux
+
+class CTimerLinuxTimerFd : public CTimerImpl
+{
+private:
+    enum
+    {
+        MAX_EPOLL_EVENTS = 64,              // epoll_wait 한번에 처리하는 최대 Timer 수
+    };
+    static const uint64_t WAKE_EVENT_KEY = UINT64_MAX;
+
+    int                 m_epoll_fd = -1;
+    int                 m_wake_fd  = -1;    // dispatch thread 를 깨우는 eventfd (종료, 삭제된 timerfd close)
+    std::atomic<bool>   m_stop{ false };
+    std::thread         m_threadDispatch;
+
+    // 삭제된 timerfd 는 dispatch thread 가 처리 중인 epoll batch 에 남아 있을 수 있으므로
+    // batch 가 끝난 후에 dispatch thread 에서 close 한다. 그 전에 close 하면 같은 번호로 재사용된 fd 를 read 하게 된다.
+    std::mutex          m_mutex_closing;
+    std::vector<int>    m_closing_fds;
+
+private:
+    static uint64_t MakeEventKey(TimerIdEx id)
+    {
+        return (uint64_t)(uint32_t)id;
+    }
+
+    void WakeDispatch()
+    {
+        uint64_t value = 1;
+        if (m_wake_fd >= 0 && sizeof(value) != write(m_wake_fd, &value, sizeof(value)))
+            fprintf(stderr, "eventfd write");
+    }
+
+    void CloseDeletedFds()
+    {
+        std::vector<int> closing_fds;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex_closing);
+            closing_fds.swap(m_closing_fds);
+        }
+
+        for (int fd : closing_fds)
+            close(fd);
+    }
+
+    ///  @brief      id 의 record 를 pin 한 상태에서 generation 을 확인하고 record 의 timerfd 를 read 한 후 Callback 을 호출 한다.
+    void DispatchTimer(TimerIdEx id)
+    {
+        ParamTimer* slot = GetCallBackSlot(id);
+        if (nullptr == slot)
+            return;
+
+        CReadGuard guard(*slot);
+
+        TimerRecord* record = ReadRecord(*slot, id);
+        if (nullptr == record)
+            return;     // 이미 삭제 되었거나 다른 Timer 로 재사용된 slot
+
+        uint64_t expirations = 0;
+        if (sizeof(expirations) != read(record->fd, &expirations, sizeof(expirations)))
+            return;     // 만료 되지 않은 경우
+
+        if (record->func)
+            record->func(id, record->ptr, expirations > INT32_MAX ? INT32_MAX : (int)expirations);
+    }
+
+    /**
+     * @brief threadDispatch
+     *
+     * 하나의 Thread 에서 epoll 로 모든 timerfd 를 감시한다.
+     * Callback 은 Signal handler 가 아닌 일반 Thread context 에서 호출된다.
+     * epoll_wait 한번에 준비된 timerfd 들을 모아서 처리하고
+     * 각 timerfd 는 read 한번으로 누적된 만료 횟수를 가져온다.
+     */
+    void threadDispatch()
+    {
+        struct epoll_event events[MAX_EPOLL_EVENTS];
+
+        while (false == m_stop)
+        {
+            int count = epoll_wait(m_epoll_fd, events, MAX_EPOLL_EVENTS, -1);
+            if (count < 0)
+            {
+                if (EINTR == errno)
+                    continue;
+                break;
+            }
+
+            for (int ii = 0; ii < count; ii++)
+            {
+                uint64_t key = events[ii].data.u64;
+                if (WAKE_EVENT_KEY == key)
+                {
+                    // eventfd 의 counter 를 비운다. 종료 여부는 m_stop 으로 확인 한다.
+                    uint64_t value = 0;
+                    if (read(m_wake_fd, &value, sizeof(value)) < 0 && EAGAIN != errno)
+                        fprintf(stderr, "eventfd read");
+                    continue;
+                }
+
+                DispatchTimer((TimerIdEx)(uint32_t)key);
+            }
+
+            CloseDeletedFds();
+        }
+    }
+
+public:
+    CTimerLinuxTimerFd()
+    {
+    }
+    virtual ~CTimerLinuxTimerFd()
+    {
+    }
+
+    virtual int Initialize() override
+    {
+        m_stop = false;
+
+        m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (m_epoll_fd < 0)
+            return 1;
+
+        m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_wake_fd < 0)
+        {
+            CloseControlFds();
+            return 2;
+        }
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u64 = WAKE_EVENT_KEY;
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &ev))
+        {
+            CloseControlFds();
+            return 3;
+        }
+
+        m_threadDispatch = std::thread(std::bind(&CTimerLinuxTimerFd::threadDispatch, this));
 
         return 0;
     }
+
+    virtual int Finalize() override
+    {
+        DeleteTimerAll();
+
+        m_stop = true;
+        WakeDispatch();
+
+        if (m_threadDispatch.joinable())
+            m_threadDispatch.join();
+
+        CloseDeletedFds();
+        CloseControlFds();
+
+        return 0;
+    }
+
+    virtual int CreateTimer(TimerIdEx& id, const ParamTimer& param) override
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
+
+        int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (fd < 0)
+            return 1;
+
+        id = CreateTimerId();
+        if (-1 == id)
+        {
+            close(fd);
+            return 4;
+        }
+
+        // Save Timer Inforamtion
+        ParamTimer& item = GetReservedTimer(id);
+        item.fd   = fd;
+        item.ns   = param.ns;
+        item.func = param.func;
+        item.ptr  = param.ptr;
+        PublishTimer(id);
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u64 = MakeEventKey(id);
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev))
+        {
+            DeleteTimer(id);
+            return 2;
+        }
+
+        // set alarm
+        struct itimerspec its;
+        SetTimerSpec(its, param);
+        if (timerfd_settime(fd, param.first > 0 ? TFD_TIMER_ABSTIME : 0, &its, NULL))
+        {
+            DeleteTimer(id);
+            return 3;
+        }
+
+        return 0;
+    }
+
+    virtual int DeleteTimer(const TimerIdEx& id) override
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
+
+        ParamTimer* item = GetTimer(id);
+        if (nullptr == item)
+            return 1;
+
+        if (item->fd >= 0)
+        {
+            epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, item->fd, NULL);
+
+            // dispatch thread 가 처리 중인 batch 가 끝난 후에 close 한다.
+            {
+                std::lock_guard<std::mutex> lock(m_mutex_closing);
+                m_closing_fds.push_back(item->fd);
+            }
+            if (m_threadDispatch.get_id() != std::this_thread::get_id())
+                WakeDispatch();
+        }
+        item->fd = -1;
+        ReleaseTimerId(id);
+
+        return 0;
+    }
+
+private:
+    void CloseControlFds()
+    {
+        if (m_wake_fd >= 0)
+            close(m_wake_fd);
+        if (m_epoll_fd >= 0)
+            close(m_epoll_fd);
+        m_wake_fd  = -1;
+        m_epoll_fd = -1;
+    }
 };
 #endif
 
+//////////////////////////////////////////////////////////////////////////
+// class CTimerVirtual
+//////////////////////////////////////////////////////////////////////////
+
+// OS Timer 를 사용하지 않고 AdvanceTime() 으로 진행되는 가상 시간에서 동작하는 Timer
+// Callback 은 AdvanceTime() 을 호출한 Thread 에서 deadline 순서대로 호출 되며
+// deadline 이 같으면 먼저 생성된 Timer 가 먼저 호출되기 때문에 항상 같은 순서로 동작한다.
+class CTimerVirtual : public CTimerImpl
+{
+private:
+    struct Deadline
+    {
+        long long   time = 0;       // 가상 시간 (nanosecond)
+        long long   order = 0;      // deadline 이 같을 때의 호출 순서
+        TimerIdEx   id = -1;
+
+        bool operator>(const Deadline& other) const
+        {
+            if (time != other.time)
+                return time > other.time;
+            return order > other.order;
+        }
+    };
+
+    std::atomic<long long>  m_now{ 0 };
+    long long               m_order = 0;
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> m_deadlines;
+
+private:
+    void PushDeadline(TimerIdEx id, long long time)
+    {
+        Deadline deadline;
+        deadline.time  = time;
+        deadline.order = m_order++;
+        deadline.id    = id;
+        m_deadlines.push(deadline);
+    }
+
+    // target 까지의 deadline 중에서 가장 빠른 Timer 를 호출 한다.
+    bool Step(long long target)
+    {
+        TimerIdEx id = -1;
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
+
+            while (m_deadlines.size())
+            {
+                Deadline deadline = m_deadlines.top();
+                if (deadline.time > target)
+                    return false;
+                m_deadlines.pop();
+
+                ParamTimer* item = GetTimer(deadline.id);
+                if (nullptr == item)    // 삭제된 Timer
+                    continue;
+
+                m_now.store(deadline.time);
+                PushDeadline(deadline.id, deadline.time + item->ns);
+                id = deadline.id;
+                break;
+            }
+        }
+
+        if (-1 == id)
+            return false;
+
+        CallBack(id);
+
+        return true;
+    }
+
+public:
+    CTimerVirtual()
+    {
+    }
+
+    virtual ~CTimerVirtual()
+    {
+    }
+
+    virtual int Initialize() override
+    {
+        return 0;
+    }
+
+    virtual int Finalize() override
+    {
+        DeleteTimerAll();
+
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
+        while (m_deadlines.size())
+            m_deadlines.pop();
+
+        return 0;
+    }
+
+    virtual std::chrono::nanoseconds GetTime() override
+    {
+        return std::chrono::nanoseconds(m_now.load());
+    }
+
+    virtual int CreateTimer(TimerIdEx& id, const ParamTimer& param) override
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
+
+        id = CreateTimerId();
+        if (-1 == id)
+            return 1;
+
+        ParamTimer& item = GetReservedTimer(id);
+        item.ns   = param.ns;
+        item.func = param.func;
+        item.ptr  = param.ptr;
+        PublishTimer(id);
+
+        PushDeadline(id, param.first > 0 ? param.first : m_now.load() + param.ns);
+
+        return 0;
+    }
+
+    virtual int DeleteTimer(const TimerIdEx& id) override
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
+
+        if (nullptr == GetTimer(id))
+            return 1;
+
+        ReleaseTimerId(id);     // deadline 은 호출 시점에 제거 된다.
+
+        return 0;
+    }
+
+    ///  @brief      가상 시간을 duration 만큼 진행하면서 그 사이의 모든 Callback 을 호출 한다.
+    int AdvanceTime(std::chrono::nanoseconds duration)
+    {
+        long long target = m_now.load() + duration.count();
+        while (Step(target))
+        {
+        }
+        m_now.store(target);
+
+        return 0;
+    }
+
+    ///  @brief      다음 deadline 까지 가상 시간을 진행하고 Callback 을 호출 한다.
+    int AdvanceTimeToNext()
+    {
+        long long target = 0;
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex_timers);
+
+            while (m_deadlines.size() && nullptr == GetTimer(m_deadlines.top().id))
+                m_deadlines.pop();
+            if (m_deadlines.empty())
+                return 1;
+
+            target = m_deadlines.top().time;
+        }
+
+        return AdvanceTime(std::chrono::nanoseconds(target - m_now.load()));
+    }
+};
+
 //////////////////////////////////////////////////////////////////////////
 // class CTimerInstance
 //////////////////////////////////////////////////////////////////////////
@@ -381,11 +1064,13 @@ public:
         TIMER_NONE      = 0,
         WINDOWS_MMTIMER = 1,
         LINUX_SIGNAL    = 10,
+        LINUX_TIMERFD   = 11,
+        TIMER_VIRTUAL   = 20,
     };
 
 private:
     std::unique_ptr<CTimerImpl>     m_impl;
-    ActiveType                      m_type;
+    ActiveType                      m_type = TIMER_NONE;
 
 private:
     CTimerInstance()
@@ -420,14 +1105,27 @@ public:
                 m_impl.reset(new CTimerLinuxSignal);
 #endif
                 break;
+            case CTimerInstance::LINUX_TIMERFD:
+#ifdef __linux
+                m_impl.reset(new CTimerLinuxTimerFd);
+#endif
+                break;
+            case CTimerInstance::TIMER_VIRTUAL:
+                m_impl.reset(new CTimerVirtual);
+                break;
             case CTimerInstance::TIMER_NONE:
             default:
                 break;
             }
 
+            if (nullptr == m_impl)
+                return 100;
+
             m_type = type;
 
             ret = m_impl->Initialize();
+            if (ret)
+                m_impl.reset();
         }
 
         if (nullptr == m_impl)
@@ -438,22 +1136,56 @@ public:
 
     int Finalize()
     {
-        return m_impl->Finalize();
+        if (nullptr == m_impl)
+            return 0;
+
+        int ret = m_impl->Finalize();
+        m_impl.reset();
+        m_type = TIMER_NONE;
+
+        return ret;
+    }
+
+    ActiveType GetType() const
+    {
+        return m_type;
     }
 
     int CreateTimer(TimerIdEx& id, const CTimerImpl::ParamTimer& param)
     {
+        if (nullptr == m_impl)
+            return 100;
+
         return m_impl->CreateTimer(id, param);
     }
 
     int DeleteTimer(const TimerIdEx& id)
     {
+        if (nullptr == m_impl)
+            return 100;
+
         return m_impl->DeleteTimer(id);
     }
 
-    void CallBack(TimerIdEx id)
+    std::chrono::nanoseconds GetTime()
     {
-        m_impl->CallBack(id);
+        if (nullptr == m_impl)
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+
+        return m_impl->GetTime();
+    }
+
+    CTimerVirtual* GetVirtual()
+    {
+        if (TIMER_VIRTUAL != m_type)
+            return nullptr;
+
+        return static_cast<CTimerVirtual*>(m_impl.get());
+    }
+
+    void CallBack(TimerIdEx id, int expirations = 1)
+    {
+        m_impl->CallBack(id, expirations);
     }
 };
 
@@ -470,12 +1202,44 @@ namespace timer_ex
 #ifdef WIN32
         CTimerInstance::ActiveType type = CTimerInstance::WINDOWS_MMTIMER;
 #else
-        CTimerInstance::ActiveType type = CTimerInstance::LINUX_SIGNAL;
+        CTimerInstance::ActiveType type = CTimerInstance::LINUX_TIMERFD;
 #endif
 
         return instance.Initialize(type);
     }
 
+    int InitializeVirtualTimer()
+    {
+        CTimerInstance& instance = CTimerInstance::GetInstance();
+        if (CTimerInstance::TIMER_NONE != instance.GetType() && CTimerInstance::TIMER_VIRTUAL != instance.GetType())
+            return 101;     // 이미 다른 Timer 로 초기화 되어 있다.
+
+        return instance.Initialize(CTimerInstance::TIMER_VIRTUAL);
+    }
+
+    int AdvanceVirtualTimer(std::chrono::nanoseconds duration)
+    {
+        CTimerVirtual* timer = CTimerInstance::GetInstance().GetVirtual();
+        if (nullptr == timer)
+            return 1;
+
+        return timer->AdvanceTime(duration);
+    }
+
+    int AdvanceVirtualTimerToNext()
+    {
+        CTimerVirtual* timer = CTimerInstance::GetInstance().GetVirtual();
+        if (nullptr == timer)
+            return 1;
+
+        return timer->AdvanceTimeToNext();
+    }
+
+    std::chrono::nanoseconds GetTimerTime()
+    {
+        return CTimerInstance::GetInstance().GetTime();
+    }
+
     int FinalizeTimer()
     {
         CTimerInstance& instance = CTimerInstance::GetInstance();
@@ -484,12 +1248,36 @@ namespace timer_ex
 
     int CreateTimer(TimerIdEx& id, int ms, std::function<void(TimerIdEx id, void* ptr)> func, void* ptr)
     {
+        return CreateTimer(id, std::chrono::milliseconds(ms), func, ptr);
+    }
+
+    int CreateTimer(TimerIdEx& id, std::chrono::nanoseconds period, std::function<void(TimerIdEx id, void* ptr)> func, void* ptr)
+    {
+        auto func_ex = [func](TimerIdEx id, void* ptr, int) {
+            if (func)
+                func(id, ptr);
+        };
+
+        return CreateTimer(id, period, func_ex, ptr);
+    }
+
+    int CreateTimer(TimerIdEx& id, std::chrono::nanoseconds period, std::function<void(TimerIdEx id, void* ptr, int expirations)> func, void* ptr)
+    {
+        return CreateTimer(id, period, std::chrono::nanoseconds(0), func, ptr);
+    }
+
+    int CreateTimer(TimerIdEx& id, std::chrono::nanoseconds period, std::chrono::nanoseconds first, std::function<void(TimerIdEx id, void* ptr, int expirations)> func, void* ptr)
+    {
+        if (period.count() <= 0)
+            return 1;
+
         CTimerInstance& instance = CTimerInstance::GetInstance();
 
         CTimerImpl::ParamTimer param;
-        param.ms   = ms;
-        param.func = func;
-        param.ptr  = ptr;
+        param.ns    = period.count();
+        param.first = first.count() > 0 ? first.count() : 0;
+        param.func  = func;
+        param.ptr   = ptr;
 
         return instance.CreateTimer(id, param);
     }
@@ -501,3 +1289,127 @@ namespace timer_ex
         return instance.DeleteTimer(id);
     }
 }; // namespace timer_ex
+
+//////////////////////////////////////////////////////////////////////////
+// Benchmark
+//////////////////////////////////////////////////////////////////////////
+
+int BenchTimerCallBack()
+{
+    typedef std::chrono::steady_clock chrono_clock;
+
+    enum
+    {
+        TIMER_COUNT     = 64,
+        CALL_COUNT      = 4000000,      // Thread 당 CallBack 호출 횟수
+        READER_COUNT    = 4,
+    };
+
+    // OS Timer 가 실제로 만료되지 않도록 주기를 길게 설정 한다.
+    const std::chrono::nanoseconds period = std::chrono::hours(1);
+
+    if (InitializeTimer())
+        return 1;
+
+    std::atomic<long long> call_count(0);
+    std::atomic<long long> error_count(0);
+
+    // seq 를 ptr 로 넘기기 때문에 func 와 ptr 이 다른 Timer 의 것으로 섞이면 error 로 집계 된다.
+    auto make_func = [&](long long seq) {
+        return [&call_count, &error_count, seq](TimerIdEx, void* ptr, int) {
+            if ((long long)(intptr_t)ptr != seq)
+                error_count++;
+            call_count.fetch_add(1, std::memory_order_relaxed);
+        };
+    };
+
+    std::atomic<TimerIdEx> ids[TIMER_COUNT];
+    long long seq = 0;
+    for (int ii = 0; ii < TIMER_COUNT; ii++)
+    {
+        TimerIdEx id = -1;
+        if (CreateTimer(id, period, make_func(seq), (void*)(intptr_t)seq))
+            return 2;
+        ids[ii].store(id);
+        seq++;
+    }
+
+    // 1. 단일 Thread 에서 기존 방식 (lock 없이 slot 을 직접 참조) 과 호출 비용을 비교 한다.
+    auto measure = [&](bool legacy) {
+        chrono_clock::time_point start = chrono_clock::now();
+        for (int ii = 0; ii < CALL_COUNT; ii++)
+        {
+            TimerIdEx id = ids[ii % TIMER_COUNT].load(std::memory_order_relaxed);
+            if (legacy)
+            {
+                CTimerImpl::ParamTimer* item = CTimerImpl::GetTimer(id);
+                if (item && item->func)
+                    item->func(id, item->ptr, 1);
+            }
+            else
+            {
+                CTimerImpl::CallBack(id);
+            }
+        }
+        return std::chrono::duration<double, std::nano>(chrono_clock::now() - start).count() / CALL_COUNT;
+    };
+
+    double legacy_ns = measure(true);
+    double rcu_ns    = measure(false);
+    printf("%-28s %10.2f ns/call\n", "unprotected slot read", legacy_ns);
+    printf("%-28s %10.2f ns/call\n", "guarded record read", rcu_ns);
+
+    // 2. 여러 Thread 에서 CallBack 을 호출하는 동안 Timer 를 계속 삭제/생성 한다.
+    std::atomic<bool>      running(true);
+    std::atomic<long long> churn_count(0);
+
+    std::thread churn([&]() {
+        unsigned int index = 0;
+        while (running.load())
+        {
+            std::atomic<TimerIdEx>& slot = ids[index++ % TIMER_COUNT];
+
+            DeleteTimer(slot.load());
+
+            TimerIdEx id = -1;
+            if (CreateTimer(id, period, make_func(seq), (void*)(intptr_t)seq))
+                error_count++;
+            slot.store(id);
+            seq++;
+            churn_count++;
+        }
+    });
+
+    call_count.store(0);
+    chrono_clock::time_point start = chrono_clock::now();
+
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < READER_COUNT; reader++)
+    {
+        readers.push_back(std::thread([&, reader]() {
+            unsigned int state = 2463534242u + reader;
+            for (int ii = 0; ii < CALL_COUNT; ii++)
+            {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+
+                CTimerImpl::CallBack(ids[state % TIMER_COUNT].load(std::memory_order_relaxed));
+            }
+        }));
+    }
+    for (std::thread& reader : readers)
+        reader.join();
+
+    double elapsed = std::chrono::duration<double>(chrono_clock::now() - start).count();
+    running.store(false);
+    churn.join();
+
+    printf("%-28s %10.2f Mcall/s (%d threads, %lld delete/create, %lld calls, %lld errors)\n", "guarded record under churn",
+        READER_COUNT * (double)CALL_COUNT / elapsed / 1000000, READER_COUNT, churn_count.load(), call_count.load(), error_count.load());
+
+    for (std::atomic<TimerIdEx>& id : ids)
+        DeleteTimer(id.load());
+
+    return error_count.load() ? 3 : 0;
+}
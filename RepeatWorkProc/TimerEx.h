@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include <chrono>
 #include <functional>
 
 //////////////////////////////////////////////////////////////////////////
@@ -8,7 +9,7 @@
 ///  @author  Lee Jong Oh
 ///  @brief   Windows, Linux 에서 사용하는 Timer API
 ///           Windows 는 MMTimer 를 이용하여 구현
-///           Linux 는 Signal 방식으로 구현
+///           Linux 는 timerfd + epoll 방식으로 구현 (Signal 방식도 선택 가능)
 
 namespace timer_ex
 {
@@ -23,6 +24,25 @@ namespace timer_ex
     ///  @return     성공 시에 0, 실패 시에 1 이상의 값을 return 한다.
     int FinalizeTimer();
 
+    ///  @brief      OS Timer 대신 가상 시간으로 동작하는 Timer 로 초기화 한다. 시뮬레이션, 테스트, 벤치마크 용도로 사용 한다.
+    ///              Callback 은 AdvanceVirtualTimer() 를 호출한 Thread 에서 deadline 순서대로 호출 된다.
+    ///              CTimerLockerManager 등 Timer 를 사용하는 객체를 생성하기 전에 호출 해야 한다.
+    ///  @return     성공 시에 0, 실패 시에 1 이상의 값을 return 한다.
+    int InitializeVirtualTimer();
+
+    ///  @brief      가상 시간을 duration 만큼 진행 시키면서 그 사이에 만료되는 Callback 을 모두 호출 한다.
+    ///  @param duration[in] : 진행 시킬 시간
+    ///  @return     성공 시에 0, 가상 Timer 가 아니면 1 이상의 값을 return 한다.
+    int AdvanceVirtualTimer(std::chrono::nanoseconds duration);
+
+    ///  @brief      가상 시간을 다음 deadline 까지 진행 시키고 Callback 을 호출 한다.
+    ///  @return     성공 시에 0, 가상 Timer 가 아니거나 등록된 Timer 가 없으면 1 이상의 값을 return 한다.
+    int AdvanceVirtualTimerToNext();
+
+    ///  @brief      Timer 가 사용하는 monotonic clock 의 현재 시간을 반환 한다. 가상 Timer 이면 가상 시간을 반환 한다.
+    ///  @return     steady_clock 의 epoch 부터의 시간
+    std::chrono::nanoseconds GetTimerTime();
+
     ///  @brief      Timer 객체를 생성하고 설정된 시간 마다 Callback 함수를 호출 한다.
     ///  @param id[out] : Timer 객체를 식별하는 id 값을 받아온다.
     ///  @param ms[in] : Timer 의 이벤트를 받을 시간을 설정 한다. 단위는 밀리세컨드
@@ -31,12 +51,44 @@ namespace timer_ex
     ///  @return     성공 시에 0, 실패 시에 1 이상의 값을 return 한다.
     int CreateTimer(TimerIdEx& id, int ms, std::function<void(TimerIdEx id, void* ptr)> func, void* ptr);
 
+    ///  @brief      Timer 객체를 생성하고 설정된 시간 마다 Callback 함수를 호출 한다.
+    ///              Linux 에서는 100 us 수준의 주기까지 사용 가능하며 Windows(MMTimer) 는 1 ms 단위로 반올림 된다.
+    ///  @param id[out] : Timer 객체를 식별하는 id 값을 받아온다.
+    ///  @param period[in] : Timer 의 이벤트를 받을 시간을 설정 한다. 단위는 나노세컨드
+    ///  @param func[in] : period 의 설정된 시간마다 호출되는 Callback 함수
+    ///  @param ptr[in] : func 의 ptr 인자로 넘어가는 유저 정의 값을 설정 한다.
+    ///  @return     성공 시에 0, 실패 시에 1 이상의 값을 return 한다.
+    int CreateTimer(TimerIdEx& id, std::chrono::nanoseconds period, std::function<void(TimerIdEx id, void* ptr)> func, void* ptr);
+
+    ///  @brief      Timer 객체를 생성하고 설정된 시간 마다 Callback 함수를 호출 한다.
+    ///              시스템 부하로 Callback 이 늦어진 경우 그 사이에 만료된 횟수를 expirations 로 전달 한다.
+    ///  @param id[out] : Timer 객체를 식별하는 id 값을 받아온다.
+    ///  @param period[in] : Timer 의 이벤트를 받을 시간을 설정 한다. 단위는 나노세컨드
+    ///  @param func[in] : period 의 설정된 시간마다 호출되는 Callback 함수, expirations 는 1 이상이며 1 보다 크면 누락된 event 가 있다.
+    ///  @param ptr[in] : func 의 ptr 인자로 넘어가는 유저 정의 값을 설정 한다.
+    ///  @return     성공 시에 0, 실패 시에 1 이상의 값을 return 한다.
+    int CreateTimer(TimerIdEx& id, std::chrono::nanoseconds period, std::function<void(TimerIdEx id, void* ptr, int expirations)> func, void* ptr);
+
+    ///  @brief      첫 만료 시간을 지정하여 Timer 객체를 생성 한다. 이후에는 first + k * period 마다 Callback 함수를 호출 한다.
+    ///              여러 Timer 의 위상을 맞출 때 사용하며 Windows(MMTimer) 는 첫 만료 시간을 지원하지 않아 생성 시점부터 period 마다 호출 된다.
+    ///  @param id[out] : Timer 객체를 식별하는 id 값을 받아온다.
+    ///  @param period[in] : Timer 의 이벤트를 받을 시간을 설정 한다. 단위는 나노세컨드
+    ///  @param first[in] : 첫 만료 시간, GetTimerTime() 과 같은 clock 의 절대 시간이며 지난 시간이면 바로 호출 된다.
+    ///  @param func[in] : Callback 함수, expirations 는 1 이상이며 1 보다 크면 누락된 event 가 있다.
+    ///  @param ptr[in] : func 의 ptr 인자로 넘어가는 유저 정의 값을 설정 한다.
+    ///  @return     성공 시에 0, 실패 시에 1 이상의 값을 return 한다.
+    int CreateTimer(TimerIdEx& id, std::chrono::nanoseconds period, std::chrono::nanoseconds first, std::function<void(TimerIdEx id, void* ptr, int expirations)> func, void* ptr);
+
     ///  @brief      Timer 객체를 삭제한다.
     ///  @param id[in] : CreateTimer api 에서 얻어온 id 값
     ///  @return     성공 시에 0, 실패 시에 1 이상의 값을 return 한다.
     int DeleteTimer(const TimerIdEx& id);
 };
 
+///  @brief      Timer 를 삭제/생성 하는 동안 여러 Thread 에서 Callback 을 호출하여 처리량과 안전성을 측정하여 출력 한다.
+///  @return     성공 시에 0, 잘못된 Callback 호출이 발견되면 1 이상의 값을 return 한다.
+int BenchTimerCallBack();
+
 // Sample code
 #if 0
 #include "TimerEx.h"
@@ -1,24 +1,136 @@
 ﻿#include "TimerLockerManager.h"
 #include "TimerEx.h"
+#include "InnerThread.h"
 
 #include <vector>
+#include <map>
+#include <algorithm>
 #include <cmath>
-#include <basetsd.h>
+#include <cstdio>
+#include <thread>
+#include <queue>
+#include <cstdint>
+#include <random>
+#include <climits>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define TIMER_RESOLUTION_LIMIT_US   (100)   // 설정 가능한 최소 해상도 (microsecond)
+#define ONE_SEC_TO_NSEC             (1000000000)
+
+// timer_ex 의 clock 을 사용해야 가상 Timer 에서도 같은 시간으로 동작 한다.
+static std::chrono::steady_clock::time_point GetTimerNow()
+{
+    using time_point = std::chrono::steady_clock::time_point;
+    return time_point(std::chrono::duration_cast<time_point::duration>(timer_ex::GetTimerTime()));
+}
+
+// expire[ii] <= tick 인 item 의 bit 를 mask 에 설정 한다. mask 는 (count + 63) / 64 개이며 0 으로 초기화 되어 있어야 한다.
+static void GetDueMaskScalar(const long long* expire, size_t count, long long tick, uint64_t* mask, size_t begin = 0)
+{
+    for (size_t ii = begin; ii < count; ii++)
+        mask[ii / 64] |= (uint64_t)(expire[ii] <= tick ? 1 : 0) << (ii % 64);     // 분기 없이 비교 한다.
+}
+
+// GetDueMaskScalar() 와 같은 결과를 AVX2 (4개) 또는 SSE4.2 (2개) 단위로 계산 한다. 지원하지 않으면 scalar 로 계산 한다.
+static void GetDueMask(const long long* expire, size_t count, long long tick, uint64_t* mask)
+{
+    size_t ii = 0;
+#if defined(__AVX2__)
+    const __m256i limit = _mm256_set1_epi64x(tick);
+    for (; ii + 4 <= count; ii += 4)
+    {
+        __m256i value   = _mm256_loadu_si256((const __m256i*)(expire + ii));
+        int     not_due = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(value, limit)));
+        mask[ii / 64] |= (uint64_t)(~not_due & 0xF) << (ii % 64);
+    }
+#elif defined(__SSE4_2__)
+    const __m128i limit = _mm_set1_epi64x(tick);
+    for (; ii + 2 <= count; ii += 2)
+    {
+        __m128i value   = _mm_loadu_si128((const __m128i*)(expire + ii));
+        int     not_due = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(value, limit)));
+        mask[ii / 64] |= (uint64_t)(~not_due & 0x3) << (ii % 64);
+    }
+#endif
+    GetDueMaskScalar(expire, count, tick, mask, ii);
+}
+
+static int GetLowestBit(uint64_t bits)
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward64(&index, bits);
+    return (int)index;
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+static long long GetGcd(long long a, long long b)
+{
+    while (b)
+    {
+        long long r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+// a * b / c 를 128 bit 중간 값으로 계산 한다. a, b 는 0 이상, c 는 0 보다 커야 하며 결과는 long long 범위 안이어야 한다.
+static long long MulDiv(long long a, long long b, long long c)
+{
+#ifdef __SIZEOF_INT128__
+    return (long long)((unsigned __int128)a * (unsigned long long)b / (unsigned long long)c);
+#else
+    // 32 bit 단위로 곱하여 128 bit 값 (hi, lo) 을 만든 후에 1 bit 씩 나눈다.
+    uint64_t a_lo = (uint64_t)a & 0xFFFFFFFF, a_hi = (uint64_t)a >> 32;
+    uint64_t b_lo = (uint64_t)b & 0xFFFFFFFF, b_hi = (uint64_t)b >> 32;
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + a_lo * b_hi;
+    uint64_t hi    = (hi_lo >> 32) + (cross >> 32) + a_hi * b_hi;
+    uint64_t lo    = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+
+    uint64_t divisor  = (uint64_t)c;
+    uint64_t quotient = 0;
+    uint64_t remain   = 0;
+    for (int bit = 127; bit >= 0; bit--)
+    {
+        remain   = (remain << 1) | ((bit >= 64 ? hi >> (bit - 64) : lo >> bit) & 1);
+        quotient = quotient << 1;
+        if (remain >= divisor)      // c 가 2^63 보다 작기 때문에 remain 은 넘치지 않는다.
+        {
+            remain   -= divisor;
+            quotient |= 1;
+        }
+    }
+    return (long long)quotient;
+#endif
+}
 
 //////////////////////////////////////////////////////////////////////////
 // class CTimerLocker
 
-CTimerLocker::CTimerLocker(const std::string& name, int period)
-    : m_name(name)
-    , m_period(period)
+CTimerLocker::CTimerLocker(const std::string& name, Duration period)
+    : CTimerLocker(name, period, CallBackTimer())
 {
 }
 
-CTimerLocker::CTimerLocker(const std::string& name, int period, const CallBackTimer& callback)
+CTimerLocker::CTimerLocker(const std::string& name, Duration period, const CallBackTimer& callback)
     : m_name(name)
     , m_period(period)
+    , m_period_num(period.count())
     , m_callback(callback)
 {
+    if (period.count() > 0)     // 한번만 호출되는 Timer task 는 통계를 기록하지 않는다.
+        m_stats.reset(new CTimerStats());
 }
 
 CTimerLocker::~CTimerLocker()
@@ -35,279 +147,1680 @@ std::string CTimerLocker::GetName() const
     return m_name;
 }
 
+CTimerLocker::Handle CTimerLocker::GetHandle() const
+{
+    return m_handle;
+}
+
 int CTimerLocker::GetPeriod() const
+{
+    return (int)std::chrono::duration_cast<std::chrono::milliseconds>(m_period + std::chrono::microseconds(500)).count();
+}
+
+std::chrono::nanoseconds CTimerLocker::GetPeriodNs() const
 {
     return m_period;
 }
 
 int CTimerLocker::GetFps() const
 {
-    int fps = (int)std::round(1000 / m_period);
+    int fps = (int)std::round(GetRate());
     return fps;
 }
 
-//////////////////////////////////////////////////////////////////////////
-// class CTimerList
+double CTimerLocker::GetRate() const
+{
+    if (0 == m_period_num)      // 한번만 호출되는 Timer task
+        return 0;
+    return 1000000000.0 * m_period_den / m_period_num;
+}
 
-class CTimerLockerManager::CTimerLockerList
+long long CTimerLocker::GetFrameError() const
 {
-private:
-    int                     m_period = 0;
-    float                   m_fps    = 0;
-    timer_ex::TimerIdEx     m_timer_id = -1;
+    if (0 == m_period_num)
+        return 0;
+    return m_event_count.load(std::memory_order_relaxed) - GetFireIndex(GetTimerNow());
+}
 
-    std::recursive_mutex    m_mutex_lockers;
-    std::vector<std::unique_ptr<CTimerLocker>>  m_lockers;
+int CTimerLocker::GetMissedCount() const
+{
+    return m_missed_count;
+}
 
-public:
-    CTimerLockerList(int ms)
-        : m_period(ms)
+CTimerLocker::OverrunPolicy CTimerLocker::GetOverrunPolicy() const
+{
+    return m_overrun_policy;
+}
+
+std::chrono::nanoseconds CTimerLocker::GetSlack() const
+{
+    return m_slack;
+}
+
+double CTimerLocker::GetDrift() const
+{
+    return m_drift.load(std::memory_order_relaxed) / 1000000.0;
+}
+
+double CTimerLocker::GetMaxDrift() const
+{
+    return m_max_drift.load(std::memory_order_relaxed) / 1000000.0;
+}
+
+std::chrono::steady_clock::time_point CTimerLocker::GetLastDeadline() const
+{
+    return TimePoint(std::chrono::duration_cast<TimePoint::duration>(std::chrono::nanoseconds(m_last_deadline.load(std::memory_order_relaxed))));
+}
+
+int CTimerLocker::GetStats(TimerStats& stats) const
+{
+    if (nullptr == m_stats)
+        return 1;
+
+    m_stats->GetStats(stats);
+    return 0;
+}
+
+void CTimerLocker::ResetStats()
+{
+    if (m_stats)
+        m_stats->Reset();
+}
+
+CTimerLocker::TimePoint CTimerLocker::GetDeadline() const
+{
+    return m_start + GetFireOffset(m_fire_index);
+}
+
+// fire_index * m_period_num / m_period_den 를 overflow 없이 계산 한다.
+// 나머지 항은 m_period_num * m_period_den 까지 커질 수 있기 때문에 (예: 12.345678 fps) 128 bit 로 계산 한다.
+CTimerLocker::Duration CTimerLocker::GetFireOffset(long long fire_index) const
+{
+    return Duration(fire_index / m_period_den * m_period_num + MulDiv(fire_index % m_period_den, m_period_num, m_period_den));
+}
+
+// time 이전에 지나간 deadline 의 수 (time 이하인 가장 큰 fire index) 를 반환 한다.
+long long CTimerLocker::GetFireIndex(const TimePoint& time) const
+{
+    long long elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(time - m_start).count();
+    if (elapsed < 0)
+        return 0;
+
+    return elapsed / m_period_num * m_period_den + MulDiv(elapsed % m_period_num, m_period_den, m_period_num);
+}
+
+void CTimerLocker::UpdateDrift(const TimePoint& now)
+{
+    TimePoint deadline = GetDeadline();
+    m_last_deadline.store(std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count(), std::memory_order_relaxed);
+    if (m_stats)
+        m_stats->Record(now, deadline);
+
+    long long drift = std::chrono::duration_cast<std::chrono::nanoseconds>(now - deadline).count();
+    m_drift.store(drift, std::memory_order_relaxed);
+
+    if (std::abs(drift) > std::abs(m_max_drift.load(std::memory_order_relaxed)))
+        m_max_drift.store(drift, std::memory_order_relaxed);
+}
+
+// Timer 에서 event 가 발생했을 때 executor 로 전달할 callback 을 추가 한다.
+// 이미 전달되어 대기 또는 실행 중이면 호출 수만 늘리고 false 를 반환 한다.
+bool CTimerLocker::QueueCallback(int missed_count)
+{
+    if (OVERRUN_BURST == m_overrun_policy)
     {
-        m_fps = (float)std::round(1000 / float(ms));
+        m_queued_fires += 1 + missed_count;
+        m_queued_missed += missed_count;
     }
-
-    ~CTimerLockerList()
+    else
     {
-        Finalize();
+        // OVERRUN_SKIP 은 대기 중인 callback 이 있으면 이번 event 를 누락된 주기로 합친다.
+        int expected = 0;
+        if (m_queued_fires.compare_exchange_strong(expected, 1))
+            m_queued_missed += missed_count;
+        else
+            m_queued_missed += missed_count + 1;
     }
 
-    int Initialize(std::function<void(timer_ex::TimerIdEx, void*)> func)
+    if (m_queued.exchange(true))
+        return false;
+
+    m_jobs++;
+    return true;
+}
+
+// executor 에서 호출 된다. m_queued 가 설정되어 있는 동안에는 다른 작업이 전달되지 않기 때문에
+// 같은 CTimerLocker 의 callback 은 동시에 호출되지 않는다.
+// 실행 중에 추가된 event 는 Timer 가 작업을 전달하지 않기 때문에 m_queued 를 해제한 후에 남아 있으면
+// 다시 m_queued 를 설정하고 true 를 반환하여 호출한 쪽에서 작업을 다시 전달하게 한다.
+bool CTimerLocker::RunQueuedCallback()
+{
+    int fire_count   = m_queued_fires.exchange(0);
+    int missed_count = m_queued_missed.exchange(0);
+    if (false == m_canceled && m_callback)
     {
-        return timer_ex::CreateTimer(m_timer_id, m_period, func, IntToPtr(m_period));
+        m_missed_count = missed_count;
+        for (int ii = 0; ii < fire_count && false == m_canceled; ii++)
+            m_callback(*this);
     }
 
-    void Finalize()
+    m_queued = false;
+    if (0 == m_queued_fires.load() || m_queued.exchange(true))
+        return false;
+
+    m_jobs++;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// class CDispatchThread
+
+// executor 를 지정하지 않은 DISPATCH_EXECUTOR 에서 작업을 순서대로 실행하는 thread
+class CTimerLockerManager::CDispatchThread : public InnerThread
+{
+private:
+    std::atomic<bool>                   m_running{ false };
+    Locker                              m_queue_event;
+    std::mutex                          m_queue_mutex;
+    std::queue<std::function<void()>>   m_queue_job;
+
+protected:
+    virtual void ThreadLoop() override
     {
+        while (true)
         {
-            std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
-            m_lockers.clear();
+            m_queue_event.Wait();
+            if (false == m_running)
+                break;
+
+            while (true)
+            {
+                std::function<void()> job;
+                {
+                    std::lock_guard<std::mutex> lock(m_queue_mutex);
+                    if (m_queue_job.empty())
+                        break;
+                    job = std::move(m_queue_job.front());
+                    m_queue_job.pop();
+                }
+                job();
+            }
         }
-        timer_ex::DeleteTimer(m_timer_id);
     }
 
-    bool HasTimer()
+public:
+    CDispatchThread()
     {
-        return -1 == m_timer_id ? false : true;
+        InnerThread::SaveThreadName("TimerLockerDispatch");
+
+        m_running = true;
+        InnerThread::StartThread();
     }
 
-    int AddItem(CTimerLocker* item)
+    virtual ~CDispatchThread()
     {
-        std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
-
-        m_lockers.push_back(std::unique_ptr<CTimerLocker>(item));
+        m_running = false;
+        m_queue_event.WakeUp();
+        InnerThread::JoinThread();
+    }
 
-        return 0;
+    void Post(const std::function<void()>& job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_queue_mutex);
+            m_queue_job.push(job);
+        }
+        m_queue_event.WakeUp();
     }
+};
+
+//////////////////////////////////////////////////////////////////////////
+// class CTimerWheel
 
-    bool DeleteItem(const std::string& name)
+// Hashed timing wheel
+// 하나의 OS Timer 가 base tick 마다 SendEvent() 를 호출하고 현재 tick 의 slot 만 검사한다.
+// base tick 은 등록된 CTimerLocker 의 m_max_tick 의 최대공약수이며 deadline 은 모두 m_origin + k * tick 위에 있다.
+// CTimerLocker 가 제거되어 최대공약수가 커지면 SetTick() 으로 base tick 을 늘린다. (m_origin 은 유지)
+// 만료 tick 이 WHEEL_SIZE 안에 있는 CTimerLocker 는 해당 tick 의 slot 에 등록 된다.
+// 그보다 먼 CTimerLocker 는 WHEEL_SIZE 개의 tick 을 한 칸으로 하는 상위 wheel 의 slot 에 있다가
+// 해당 칸의 바퀴가 시작될 때 하위 slot 으로 한번 이동 한다. (계층형 timing wheel)
+// 따라서 tick 마다 만료되는 CTimerLocker 만 검사하고 등록, 해제, 이동은 모두 O(1) 로 처리 된다.
+// slot 은 만료 tick 배열과 CTimerLocker 배열을 따로 가지며 (SoA) 만료 여부는 만료 tick 배열만 SIMD 로 비교하여 구한다.
+// tick 은 OS Timer 의 호출 횟수가 아닌 monotonic clock 으로 계산하기 때문에
+// OS Timer event 가 늦거나 누락되어도 지나간 tick 을 모두 처리하고 deadline 이 밀리지 않는다.
+class CTimerLockerManager::CTimerWheel
+{
+private:
+    enum
     {
-        std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
+        WHEEL_SIZE = 512,               // 하위 wheel 의 slot 수 (tick 단위)
+        UPPER_SIZE = 64,                // 상위 wheel 의 slot 수 (WHEEL_SIZE tick 단위), 이보다 먼 CTimerLocker 는 바퀴마다 다시 검사 한다.
+    };
+    static const size_t INVALID_SLOT = (size_t)-1;
 
-        bool ret = false;
+    CTimerLockerManager&    m_manager;
+    long long               m_tick_ns = 0;          // base tick (nanosecond)
+    long long               m_current_tick = 0;     // 마지막으로 처리한 tick
+    CTimerLocker::TimePoint m_origin;               // tick 0 의 시간
+    timer_ex::TimerIdEx     m_timer_id = -1;
 
-        auto it = m_lockers.begin();
-        while (it != m_lockers.end())
-        {
-            std::unique_ptr<CTimerLocker>& ptr = *it;
-            if (ptr->m_name == name)
-            {
-                ptr->WakeUp();
-                m_lockers.erase(it);
-                ret = true;
-                break;
-            }
-            it++;
-        }
+    std::map<long long, int>    m_max_ticks;        // 등록된 CTimerLocker 의 m_max_tick 별 개수
+    bool                        m_replan = false;   // CTimerLocker 가 제거되어 base tick 을 다시 계산해야 함
 
-        return ret;
-    }
+    std::function<void(timer_ex::TimerIdEx, void*, int)>    m_func;
 
-    CTimerLocker* GetItem(const std::string& name)
+    // items 와 expire_ticks 는 같은 index 가 같은 CTimerLocker 를 나타낸다.
+    struct Slot
     {
-        std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
+        std::vector<long long>      expire_ticks;
+        std::vector<CTimerLocker*>  items;
 
-        CTimerLocker* item = nullptr;
-        auto it = m_lockers.begin();
-        while (it != m_lockers.end())
+        void Clear()
         {
-            std::unique_ptr<CTimerLocker>& ptr = *it;
-            if (ptr->m_name == name)
-            {
-                item = ptr.get();
-                break;
-            }
-            it++;
+            expire_ticks.clear();
+            items.clear();
         }
+    };
 
-        return item;
-    }
+    std::recursive_mutex    m_mutex_lockers;
+    std::vector<std::unique_ptr<CTimerLocker>>  m_lockers;
+    std::vector<Slot>                           m_slots;
 
-    bool IsEmpty()
+    bool                                        m_sending = false;  // SendEvent() 처리 중
+    std::vector<std::unique_ptr<CTimerLocker>>  m_released;         // SendEvent() 중에 제거되어 처리가 끝난 후에 해제할 CTimerLocker
+    std::vector<uint64_t>                       m_due_mask;
+    std::vector<CTimerLocker*>                  m_due_items;
+
+private:
+    long long GetTick(const CTimerLocker::TimePoint& time) const
     {
-        std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
-        return m_lockers.empty();
+        long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time - m_origin).count();
+
+        return (ns + m_tick_ns / 2) / m_tick_ns;    // 가장 가까운 tick
     }
 
-    void SendEvent()
+    // time 이후의 첫 tick, deadline 보다 먼저 호출되지 않도록 한다.
+    long long GetTickAfter(const CTimerLocker::TimePoint& time) const
     {
-        std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
+        long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time - m_origin).count();
+        if (ns <= 0)
+            return ns / m_tick_ns;
 
-        if (m_lockers.empty())
-            return;
+        return (ns + m_tick_ns - 1) / m_tick_ns;
+    }
 
-        auto it = m_lockers.begin();
-        while (it != m_lockers.end())
-        {
-            std::unique_ptr<CTimerLocker>& ptr = *it;
+    // after_tick 이후의 tick 중에서 deadline 이후의 첫 tick 을 설정 한다. (분수 주기의 deadline 은 tick 경계에 있지 않다.)
+    // slack 이 설정되어 있으면 [deadline, deadline + slack] 범위 안에서 가장 큰 2의 거듭제곱 tick 의 배수로 정렬 한다.
+    // 같은 배수로 정렬된 CTimerLocker 들은 같은 tick 에 한번에 처리 된다.
+    void SetExpireTick(CTimerLocker* item, long long after_tick)
+    {
+        CTimerLocker::TimePoint deadline = item->GetDeadline();
 
-            ptr->m_period_count += m_period;
-            if (ptr->m_period_count >= ptr->m_period)
-            {
-                ptr->WakeUp();
-                ptr->m_period_count = 0;
-                if (ptr->m_callback)
-                    ptr->m_callback(*ptr);
-            }
-            it++;
+        long long tick = GetTickAfter(deadline);
+        if (item->m_slack.count() > 0)
+        {
+            long long range = GetTick(deadline + item->m_slack) - tick + 1;
+            long long align = 1;
+            while (align * 2 <= range)
+                align *= 2;
+            tick = (tick + align - 1) / align * align;
         }
-    }
-};
 
-//////////////////////////////////////////////////////////////////////////
-// class CTimerLockerManager
+        item->m_expire_tick = tick > after_tick ? tick : after_tick + 1;
+    }
 
-CTimerLockerManager::CTimerLockerManager()
-{
-    timer_ex::InitializeTimer();
-}
+    void Link(CTimerLocker* item)
+    {
+        size_t slot = (size_t)(item->m_expire_tick % WHEEL_SIZE);
+        if (item->m_expire_tick - m_current_tick >= WHEEL_SIZE)
+            slot = WHEEL_SIZE + (size_t)(item->m_expire_tick / WHEEL_SIZE % UPPER_SIZE);
 
-CTimerLockerManager::~CTimerLockerManager()
-{
-    m_map_timers.clear();
-}
+        Slot& target = m_slots[slot];
+        item->m_wheel_slot = slot;
+        item->m_wheel_pos  = target.items.size();
+        target.items.push_back(item);
+        target.expire_ticks.push_back(item->m_expire_tick);
+    }
 
-void CTimerLockerManager::SetTimerMinResolution(int ms)
-{
-    m_timer_min_resolution = ms;
-}
+    void Unlink(CTimerLocker* item)
+    {
+        Slot& target = m_slots[item->m_wheel_slot];
 
-int CTimerLockerManager::GetTimerMinResolution() const
-{
-    return m_timer_min_resolution;
-}
+        CTimerLocker* last = target.items.back();
+        target.items[item->m_wheel_pos]        = last;
+        target.expire_ticks[item->m_wheel_pos] = target.expire_ticks.back();
+        last->m_wheel_pos = item->m_wheel_pos;
+        target.items.pop_back();
+        target.expire_ticks.pop_back();
 
-void CTimerLockerManager::CallbackTimer(int id, int ms)
-{
-    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+        item->m_wheel_slot = INVALID_SLOT;
+    }
 
-    auto it_list = m_map_timers.find(ms);
-    if (it_list == m_map_timers.end())
-        return;
+    // slot 에서 만료 tick 이 tick 이하인 CTimerLocker 를 m_due_items 에 모은다.
+    void CollectDue(const Slot& slot, long long tick)
+    {
+        size_t count = slot.items.size();
 
-    std::unique_ptr<CTimerLockerList>& timer_list = it_list->second;
-    timer_list->SendEvent();
-};
+        m_due_items.clear();
+        m_due_mask.assign((count + 63) / 64, 0);
+        GetDueMask(slot.expire_ticks.data(), count, tick, m_due_mask.data());
 
-CTimerLockerManager::CTimerLockerList* CTimerLockerManager::GetList(int ms)
-{
-    auto func = [this](timer_ex::TimerIdEx id, void* ptr) {
-        int ms = PtrToInt(ptr);
-        CallbackTimer((int)id, ms);
-    };
+        for (size_t word = 0; word < m_due_mask.size(); word++)
+        {
+            uint64_t bits = m_due_mask[word];
+            while (bits)
+            {
+                m_due_items.push_back(slot.items[word * 64 + GetLowestBit(bits)]);
+                bits &= bits - 1;
+            }
+        }
+    }
 
-    CTimerLockerList* item_list = nullptr;
-    auto it_list = m_map_timers.find(ms);
-    if (it_list == m_map_timers.end())
+    // from_lap 다음 바퀴부터 to_lap 바퀴까지 상위 slot 에 있는 CTimerLocker 를 하위 slot 으로 옮긴다.
+    void Cascade(long long from_lap, long long to_lap)
     {
-        item_list = new CTimerLockerList(ms);
-        if (item_list->Initialize(func))
+        if (to_lap - from_lap > UPPER_SIZE)
+            from_lap = to_lap - UPPER_SIZE;
+
+        for (long long lap = from_lap + 1; lap <= to_lap; lap++)
         {
-            delete item_list;
-            return nullptr;
+            // UPPER_SIZE 바퀴 이후에 만료되는 item 은 남겨둔다.
+            CollectDue(m_slots[WHEEL_SIZE + (size_t)(lap % UPPER_SIZE)], lap * WHEEL_SIZE + WHEEL_SIZE - 1);
+            for (CTimerLocker* item : m_due_items)
+            {
+                Unlink(item);
+                Link(item);
+            }
         }
-        m_map_timers[ms] = std::unique_ptr<CTimerLockerList>(item_list);
     }
-    else
+
+    void Remove(CTimerLocker* item)
     {
-        item_list = it_list->second.get();
-    }
+        item->m_canceled = true;
 
-    return item_list;
-}
+        Unlink(item);
+        Release(item);
+    }
 
-int CTimerLockerManager::GetDivisor(int ms)
-{
-    int ret = GetTimerMinResolution();
-    for (int ii = GetTimerMinResolution(); ii <= ms; ii++)
+    void Release(CTimerLocker* item)
     {
-        if (0 == (ms % ii)) 
+        auto it = m_max_ticks.find(item->m_max_tick);
+        if (it != m_max_ticks.end() && 0 == --it->second)
         {
-            ret = ii;
-            break;
+            m_max_ticks.erase(it);
+            m_replan = true;
         }
+
+        std::unique_ptr<CTimerLocker>& last = m_lockers.back();
+        last->m_owner_pos = item->m_owner_pos;
+        std::swap(m_lockers[item->m_owner_pos], last);
+        if (m_sending)     // 처리 중인 m_due_items 에 남아 있을 수 있기 때문에 SendEvent() 가 끝난 후에 해제 한다.
+            m_released.push_back(std::move(m_lockers.back()));
+        else if (item->m_jobs > 0)     // executor 작업이 끝난 후에 해제 한다.
+            m_manager.RetireLocker(std::move(m_lockers.back()));
+        m_lockers.pop_back();
     }
 
-    return ret;
-}
+public:
+    // origin 은 모든 wheel 이 공유하는 시간으로 CTimerLocker 의 위상 (phase) 의 기준이 된다.
+    CTimerWheel(CTimerLockerManager& manager, std::chrono::nanoseconds tick, const CTimerLocker::TimePoint& origin)
+        : m_manager(manager)
+        , m_tick_ns(tick.count())
+        , m_origin(origin)
+        , m_slots(WHEEL_SIZE + UPPER_SIZE)
+    {
+    }
 
-CTimerLocker* CTimerLockerManager::GetTimerLockerByTime(const std::string& name, int ms, const CallBackTimer& callback)
-{
-    if (ms < GetTimerMinResolution())
-        ms = GetTimerMinResolution();
+    ~CTimerWheel()
+    {
+        Finalize();
+    }
 
-    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+    int Initialize(std::function<void(timer_ex::TimerIdEx, void*, int)> func)
+    {
+        m_func = func;
 
-    DeleteTimerLocker(name);  // 기존 Item 이 있다면 제거 한다.
+        m_current_tick = GetTick(GetTimerNow());
+        return timer_ex::CreateTimer(m_timer_id, std::chrono::nanoseconds(m_tick_ns), GetNextTickTime(m_tick_ns), func, this);
+    }
 
-    CTimerLockerList* item_list = GetList(GetDivisor(ms));
-    if (nullptr == item_list)
-        return nullptr;
-    if (false == item_list->HasTimer())
-        return nullptr;
+    ///  @brief : 현재 시간 이후의 첫 tick 경계를 timer_ex 의 clock 으로 반환 한다.
+    std::chrono::nanoseconds GetNextTickTime(long long tick_ns) const
+    {
+        long long elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(GetTimerNow() - m_origin).count();
+        long long first   = (elapsed / tick_ns + 1) * tick_ns;
 
-    CTimerLocker* item = new CTimerLocker(name, ms, callback);
-    item_list->AddItem(item);
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(m_origin.time_since_epoch()) + std::chrono::nanoseconds(first);
+    }
 
-    return item;
-}
+    long long GetTickNs() const
+    {
+        return m_tick_ns;
+    }
 
-CTimerLocker* CTimerLockerManager::GetTimerLockerByFps(const std::string& name, int fps, const CallBackTimer& callback)
-{
-    if (0 == fps)
-        return nullptr;
+    ///  @brief : 등록된 CTimerLocker 들이 허용하는 가장 큰 base tick 을 반환 한다.
+    long long GetPlannedTick()
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
 
-    return GetTimerLockerByTime(name, (int)std::round(1000 / fps), callback);
-}
+        m_replan = false;
 
-bool CTimerLockerManager::DeleteTimerLocker(CTimerLocker* timer_locker)
-{
-    return DeleteTimerLocker(timer_locker->GetName());
-}
+        long long tick = 0;
+        for (auto it = m_max_ticks.begin(); it != m_max_ticks.end(); it++)
+            tick = GetGcd(it->first, tick);
 
-bool CTimerLockerManager::DeleteTimerLocker(const std::string& name)
-{
-    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+        return tick ? tick : m_tick_ns;
+    }
 
-    bool ret = false;
+    bool NeedPlan() const
+    {
+        return m_replan;
+    }
 
-    auto it = m_map_timers.begin();
-    while (it != m_map_timers.end())
+    ///  @brief : base tick 을 변경 한다. 새 tick 은 기존 tick 의 약수 또는 배수이어야 한다.
+    ///           m_origin 을 유지한 채 다음 tick 경계에서 시작하는 OS Timer 를 새로 생성하고 모든 CTimerLocker 를 다시 배치 한다.
+    ///           SendEvent() 가 실행 중일 때는 호출하면 안된다.
+    int SetTick(long long tick_ns)
     {
-        CTimerLockerList* item_list = it->second.get();
-        if (item_list->DeleteItem(name))
-        {
-            if (item_list->IsEmpty())   // 모든 아이템을 제거 하면 존재해야할 필요가 없기 때문에 삭제한다.
-            {
-                item_list->Finalize();
-                m_map_timers.erase(it);
-            }
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
 
-            ret = true;
-            break;
-        }
+        if (tick_ns == m_tick_ns)
+            return 0;
 
-        it++;
-    }
+        timer_ex::TimerIdEx timer_id = -1;
+        if (timer_ex::CreateTimer(timer_id, std::chrono::nanoseconds(tick_ns), GetNextTickTime(tick_ns), m_func, this))
+            return 1;
+
+        if (HasTimer())
+            timer_ex::DeleteTimer(m_timer_id);
+        m_timer_id = timer_id;
 
-    return ret;
-}
\ No newline at end of file
+        m_current_tick = m_current_tick * m_tick_ns / tick_ns;
+        m_tick_ns      = tick_ns;
+
+        for (Slot& slot : m_slots)
+            slot.Clear();
+        for (std::unique_ptr<CTimerLocker>& item : m_lockers)
+        {
+            SetExpireTick(item.get(), m_current_tick);
+            Link(item.get());
+        }
+
+        return 0;
+    }
+
+    ///  @brief : time 이후의 가장 가까운 tick 경계의 시간을 반환 한다.
+    CTimerLocker::TimePoint AlignTime(const CTimerLocker::TimePoint& time, long long tick_ns) const
+    {
+        long long elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(time - m_origin).count();
+        if (elapsed < 0)
+            elapsed = 0;
+
+        return m_origin + std::chrono::nanoseconds((elapsed + tick_ns - 1) / tick_ns * tick_ns);
+    }
+
+    ///  @brief : 주기 CTimerLocker 를 자신의 주기 경계에 정렬하여 등록 한다. (분수 주기는 현재 base tick 경계)
+    ///           phase 가 0 이상이면 deadline 이 m_origin + phase + k * period 가 되도록 등록 한다.
+    int AddPeriodItem(CTimerLocker* item, const CTimerLocker::TimePoint& now, long long phase)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
+
+        if (phase >= 0)
+        {
+            // 시작 시간 (첫 deadline - period) 이 now 이전의 가장 가까운 위상이 되도록 한다.
+            long long elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_origin).count() - phase;
+            long long period  = item->m_period.count();
+            long long index   = elapsed >= 0 ? elapsed / period : -((period - 1 - elapsed) / period);
+            item->m_start = m_origin + std::chrono::nanoseconds(phase + index * period);
+        }
+        else
+        {
+            // wheel 의 tick 에 정렬하면 m_max_tick 이 합류한 wheel 의 tick 으로 기록되어
+            // 작은 tick 의 CTimerLocker 가 제거된 후에도 base tick 을 늘릴 수 없으므로 자신의 주기에 정렬 한다.
+            item->m_start = AlignTime(now, 1 == item->m_period_den ? item->m_period.count() : m_tick_ns);
+        }
+        item->m_fire_index = 1;
+
+        // 분수 주기의 deadline 은 tick 으로 반올림 되기 때문에 현재 base tick 을 그대로 사용 한다.
+        long long period = item->m_period.count();
+        long long offset = std::chrono::duration_cast<std::chrono::nanoseconds>(item->m_start - m_origin).count();
+        item->m_max_tick = 1 == item->m_period_den ? GetGcd(period, offset % period) : m_tick_ns;
+
+        return AddItem(item);
+    }
+
+    void Finalize()
+    {
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
+            for (Slot& slot : m_slots)
+                slot.Clear();
+            m_lockers.clear();
+        }
+        if (HasTimer())
+            timer_ex::DeleteTimer(m_timer_id);
+        m_timer_id = -1;
+    }
+
+    bool HasTimer()
+    {
+        return -1 == m_timer_id ? false : true;
+    }
+
+    timer_ex::TimerIdEx GetTimerId() const
+    {
+        return m_timer_id;
+    }
+
+    // item 의 m_start, m_fire_index 로 계산된 deadline 에 등록 한다.
+    int AddItem(CTimerLocker* item)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
+
+        m_max_ticks[item->m_max_tick]++;
+
+        item->m_owner_pos  = m_lockers.size();
+        SetExpireTick(item, m_current_tick);
+        m_lockers.push_back(std::unique_ptr<CTimerLocker>(item));
+        Link(item);
+
+        return 0;
+    }
+
+    bool HasItem(CTimerLocker* item)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
+
+        if (m_lockers.size() <= item->m_owner_pos || m_lockers[item->m_owner_pos].get() != item)
+            return false;
+
+        return true;
+    }
+
+    bool DeleteItem(CTimerLocker* item)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
+
+        if (false == HasItem(item))
+            return false;
+
+        item->WakeUp();
+        Remove(item);
+
+        return true;
+    }
+
+    bool IsEmpty()
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
+        return m_lockers.empty();
+    }
+
+    ///  @param queued[out] : nullptr 이 아니면 callback 을 호출하지 않고 executor 로 전달할 CTimerLocker 를 추가 한다.
+    ///  @return : event 를 전송한 CTimerLocker 의 수
+    size_t SendEvent(std::vector<CTimerLocker*>* queued)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_lockers);
+
+        CTimerLocker::TimePoint now = GetTimerNow();
+        long long now_tick = GetTick(now);
+        if (now_tick <= m_current_tick)
+            return 0;
+
+        // 한 바퀴 이상 밀린 경우에는 모든 slot 을 한번씩만 검사하면 된다.
+        long long tick = m_current_tick + 1;
+        if (now_tick - tick >= WHEEL_SIZE)
+            tick = now_tick - WHEEL_SIZE + 1;
+
+        long long lap = m_current_tick / WHEEL_SIZE;
+        m_current_tick = now_tick;
+        Cascade(lap, now_tick / WHEEL_SIZE);
+
+        m_sending = true;
+        size_t count = 0;
+        for (; tick <= now_tick && m_lockers.size(); tick++)
+            count += SendEvent(tick, now, queued);
+        m_sending = false;
+
+        for (std::unique_ptr<CTimerLocker>& item : m_released)
+        {
+            if (item->m_jobs > 0)
+                m_manager.RetireLocker(std::move(item));
+        }
+        m_released.clear();
+
+        return count;
+    }
+
+private:
+    size_t SendEvent(long long tick, const CTimerLocker::TimePoint& now, std::vector<CTimerLocker*>* queued)
+    {
+        // 밀린 tick 을 처리하는 중에는 다음 바퀴로 등록된 item 이 같은 slot 에 있을 수 있다.
+        size_t slot = (size_t)(tick % WHEEL_SIZE);
+        CollectDue(m_slots[slot], tick);
+
+        // callback 에서 다른 CTimerLocker 를 제거하면 slot 에서는 빠지지만 m_due_items 에는 남아 있다.
+        // 제거된 CTimerLocker 는 SendEvent() 가 끝날 때까지 해제되지 않기 때문에 m_wheel_slot 으로 확인 한다.
+        size_t count = 0;
+        for (size_t index = 0; index < m_due_items.size(); index++)
+        {
+            CTimerLocker* ptr = m_due_items[index];
+            if (ptr->m_wheel_slot != slot)    // callback 에서 제거된 item
+                continue;
+
+            ptr->UpdateDrift(now);
+            count++;
+
+            if (ptr->m_one_shot)    // 한번만 호출되는 task 는 callback 호출 후에 제거 한다.
+            {
+                Unlink(ptr);
+
+                ptr->WakeUp();
+                if (queued)
+                {
+                    if (ptr->QueueCallback(0))
+                        queued->push_back(ptr);
+                }
+                else if (ptr->m_callback)
+                {
+                    ptr->m_callback(*ptr);
+                }
+
+                Release(ptr);
+                continue;
+            }
+
+            // 다음 deadline 으로 이동 시킨다. 누락된 주기는 건너뛰지만 start + k * period 의 위상은 유지된다.
+            // 같은 slot 으로 다시 등록 되더라도 m_due_items 에는 없기 때문에 중복 처리되지 않는다.
+            long long fire_index = ptr->m_fire_index + 1;
+            ptr->m_fire_index = fire_index;
+            if (ptr->GetDeadline() <= now)
+                ptr->m_fire_index = ptr->GetFireIndex(now) + 1;
+            int missed_count = (int)(ptr->m_fire_index - fire_index);
+
+            Unlink(ptr);
+            SetExpireTick(ptr, m_current_tick);
+            Link(ptr);
+
+            int fire_count = 1;
+            if (CTimerLocker::OVERRUN_BURST == ptr->m_overrun_policy)
+                fire_count += missed_count;
+            ptr->m_event_count.fetch_add(fire_count, std::memory_order_relaxed);
+
+            // executor 로 전달하면 m_missed_count 는 callback 을 호출하는 곳에서 설정 한다.
+            if (queued)
+            {
+                for (int ii = 0; ii < fire_count; ii++)
+                    ptr->WakeUp();
+                if (ptr->QueueCallback(missed_count))
+                    queued->push_back(ptr);
+                continue;
+            }
+
+            ptr->m_missed_count = missed_count;
+            for (int ii = 0; ii < fire_count; ii++)
+            {
+                ptr->WakeUp();
+                if (ptr->m_callback)
+                    ptr->m_callback(*ptr);
+            }
+        }
+
+        return count;
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+// class CTimerLockerManager
+
+CTimerLockerManager::CTimerLockerManager()
+{
+    timer_ex::InitializeTimer();
+
+    m_origin = GetTimerNow();
+}
+
+CTimerLockerManager::~CTimerLockerManager()
+{
+    m_dispatch_thread.reset();
+
+    m_map_handles.clear();
+    m_map_names.clear();
+    m_live_wheels.clear();
+    m_wheels.clear();
+}
+
+void CTimerLockerManager::SetTimerMinResolution(int ms)
+{
+    SetTimerMinResolution(std::chrono::milliseconds(ms));
+}
+
+void CTimerLockerManager::SetTimerMinResolution(std::chrono::nanoseconds resolution)
+{
+    if (resolution < std::chrono::microseconds(TIMER_RESOLUTION_LIMIT_US))
+        resolution = std::chrono::microseconds(TIMER_RESOLUTION_LIMIT_US);
+
+    m_timer_min_resolution = resolution;
+}
+
+int CTimerLockerManager::GetTimerMinResolution() const
+{
+    return (int)std::chrono::duration_cast<std::chrono::milliseconds>(m_timer_min_resolution).count();
+}
+
+std::chrono::nanoseconds CTimerLockerManager::GetTimerMinResolutionNs() const
+{
+    return m_timer_min_resolution;
+}
+
+std::chrono::steady_clock::time_point CTimerLockerManager::GetTime() const
+{
+    return GetTimerNow();
+}
+
+// wheel 은 OS Timer 의 ptr 로 전달된 값이다. 삭제된 Timer 의 callback 이 늦게 호출될 수 있기 때문에
+// 아직 해제되지 않은 wheel 이고 현재 OS Timer 의 id 가 같은 경우에만 처리 한다.
+void CTimerLockerManager::CallbackTimer(CTimerWheel* wheel, int id, int expirations)
+{
+    if (expirations > 1)
+        m_overrun_ticks += expirations - 1;
+
+    Executor                            executor;
+    std::vector<std::function<void()>>  jobs;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+        if (0 == m_live_wheels.count(wheel) || wheel->GetTimerId() != id)
+            return;
+
+        bool is_inline = DISPATCH_INLINE == m_dispatch_mode;
+        std::vector<CTimerLocker*> queued;
+
+        // callback 에서 CTimerLocker 를 제거하더라도 SendEvent 가 끝날 때까지 Timing wheel 을 유지 한다.
+        m_dispatching_wheel = wheel;
+        size_t count = wheel->SendEvent(is_inline ? nullptr : &queued);
+        m_dispatching_wheel = nullptr;
+
+        // 같은 tick 에 처리된 CTimerLocker 들을 하나의 batch 로 보고 batch 가 끝났음을 알린다.
+        if (is_inline && count)
+        {
+            for (auto it = m_map_batch_callbacks.begin(); it != m_map_batch_callbacks.end(); it++)
+                it->second();
+        }
+
+        // executor 에서는 CTimerLocker 마다 작업을 전달하고 같은 tick 의 마지막 작업이 batch callback 을 호출 한다.
+        if (queued.size())
+        {
+            std::shared_ptr<const std::vector<CallBackBatch>> batch_callbacks = m_batch_callbacks;
+            std::shared_ptr<std::atomic<size_t>>              remaining = std::make_shared<std::atomic<size_t>>(queued.size());
+            for (CTimerLocker* item : queued)
+            {
+                jobs.push_back([this, item, remaining, batch_callbacks]() {
+                    RunTimerLocker(item);
+                    if (1 == (*remaining)-- && batch_callbacks)
+                    {
+                        for (const CallBackBatch& callback : *batch_callbacks)
+                            callback();
+                    }
+                });
+            }
+            executor = m_executor;
+        }
+
+        PlanWheels();
+    }
+
+    // executor 가 block 되더라도 Timer lock 을 잡고 있지 않도록 lock 밖에서 전달 한다.
+    if (executor)
+    {
+        for (const std::function<void()>& job : jobs)
+            executor(job);
+    }
+};
+
+void CTimerLockerManager::RunTimerLocker(CTimerLocker* item)
+{
+    if (item->RunQueuedCallback())
+    {
+        Executor executor;
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+            executor = m_executor;
+        }
+
+        auto job = [this, item]() {
+            RunTimerLocker(item);
+        };
+        if (executor)
+            executor(job);
+        else
+            job();
+    }
+
+    // m_jobs 가 0 이 되면 제거된 CTimerLocker 는 다른 thread 에서 해제될 수 있기 때문에 더이상 접근하지 않는다.
+    item->m_jobs--;
+    if (m_retired_count > 0)
+        ReclaimLockers();
+}
+
+void CTimerLockerManager::RetireLocker(std::unique_ptr<CTimerLocker> item)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex_retired);
+        m_retired_lockers.push_back(std::move(item));
+        m_retired_count = m_retired_lockers.size();
+    }
+
+    ReclaimLockers();
+}
+
+void CTimerLockerManager::ReclaimLockers()
+{
+    std::lock_guard<std::mutex> lock(m_mutex_retired);
+
+    auto it = std::remove_if(m_retired_lockers.begin(), m_retired_lockers.end(), [](const std::unique_ptr<CTimerLocker>& item) {
+        return 0 == item->m_jobs;
+    });
+    m_retired_lockers.erase(it, m_retired_lockers.end());
+    m_retired_count = m_retired_lockers.size();
+}
+
+int CTimerLockerManager::SetDispatchMode(DispatchMode mode, const Executor& executor)
+{
+    if (DISPATCH_INLINE != mode && DISPATCH_EXECUTOR != mode)
+        return 1;
+
+    std::unique_ptr<CDispatchThread> dispatch_thread;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+        // 실행 중인 callback 과 inline callback 이 동시에 호출되지 않도록 CTimerLocker 가 없을 때만 변경 한다.
+        if (m_wheels.size())
+            return 2;
+
+        m_dispatch_mode = mode;
+        m_executor      = Executor();
+        std::swap(dispatch_thread, m_dispatch_thread);   // 기존 dispatch thread 는 lock 밖에서 종료 한다.
+
+        if (DISPATCH_EXECUTOR == mode)
+        {
+            if (executor)
+            {
+                m_executor = executor;
+            }
+            else
+            {
+                m_dispatch_thread.reset(new CDispatchThread());
+                CDispatchThread* thread = m_dispatch_thread.get();
+                m_executor = [thread](const std::function<void()>& job) {
+                    thread->Post(job);
+                };
+            }
+        }
+    }
+
+    return 0;
+}
+
+CTimerLockerManager::DispatchMode CTimerLockerManager::GetDispatchMode()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+    return m_dispatch_mode;
+}
+
+// max_tick 을 base tick 의 배수로 허용하는 CTimerLocker 를 배치할 Timing wheel 을 반환 한다.
+// 기존 wheel 에 추가하면 base tick 이 gcd(tick, max_tick) 으로 줄어들고, 새 wheel 을 생성하면 max_tick 을 base tick 으로 사용한다.
+// 두 경우 중에서 초당 wakeup 수가 적게 증가하는 쪽을 선택 한다.
+CTimerLockerManager::CTimerWheel* CTimerLockerManager::GetWheel(long long max_tick)
+{
+    long long min_tick = GetTimerMinResolutionNs().count();
+
+    CTimerWheel* best      = nullptr;
+    long long    best_tick = 0;
+    double       best_cost = (double)ONE_SEC_TO_NSEC / max_tick;
+    for (std::unique_ptr<CTimerWheel>& wheel : m_wheels)
+    {
+        long long tick = wheel->GetTickNs();
+        long long join = GetGcd(tick, max_tick);
+        if (join < min_tick)
+            continue;
+        if (join != tick && wheel.get() == m_dispatching_wheel)   // SendEvent 중인 wheel 은 tick 을 변경할 수 없다.
+            continue;
+
+        double cost = (double)ONE_SEC_TO_NSEC / join - (double)ONE_SEC_TO_NSEC / tick;
+        if (cost <= best_cost)
+        {
+            best      = wheel.get();
+            best_tick = join;
+            best_cost = cost;
+        }
+    }
+
+    if (best)
+    {
+        if (best->SetTick(best_tick))
+            return nullptr;
+        return best;
+    }
+
+    return CreateWheel(max_tick);
+}
+
+// Timer task 를 배치할 Timing wheel 을 반환 한다. 다른 CTimerLocker 가 사용 중인 wheel 의 base tick 은 변경하지 않는다.
+// deadline 이 tick 경계에 있는 wheel 중에서 가장 큰 tick 의 wheel 을 먼저 사용하고, 없으면 최소 해상도 이하의 tick 을 가진 wheel 중에서
+// 가장 큰 tick 의 wheel 을 사용 한다. 둘 다 없으면 최소 해상도를 tick 으로 하는 wheel 을 새로 생성 한다.
+CTimerLockerManager::CTimerWheel* CTimerLockerManager::GetTaskWheel(const CTimerLocker::TimePoint& deadline)
+{
+    long long resolution = GetTimerMinResolutionNs().count();
+
+    // 지난 deadline 은 다음 tick 에 호출 되므로 tick 경계 여부를 보지 않는다.
+    long long offset = -1;
+    if (deadline > GetTimerNow())
+        offset = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - m_origin).count();
+
+    CTimerWheel* aligned = nullptr;
+    CTimerWheel* fine    = nullptr;
+    for (std::unique_ptr<CTimerWheel>& wheel : m_wheels)
+    {
+        if (false == wheel->HasTimer())
+            continue;
+
+        long long tick = wheel->GetTickNs();
+        if (offset >= 0 && 0 == offset % tick && (nullptr == aligned || tick > aligned->GetTickNs()))
+            aligned = wheel.get();
+        if (tick <= resolution && (nullptr == fine || tick > fine->GetTickNs()))
+            fine = wheel.get();
+    }
+
+    if (aligned)
+        return aligned;
+    if (fine)
+        return fine;
+    return CreateWheel(resolution);
+}
+
+CTimerLockerManager::CTimerWheel* CTimerLockerManager::CreateWheel(long long tick_ns)
+{
+    auto func = [this](timer_ex::TimerIdEx id, void* ptr, int expirations) {
+        CallbackTimer((CTimerWheel*)ptr, (int)id, expirations);
+    };
+
+    CTimerWheel* wheel = new CTimerWheel(*this, std::chrono::nanoseconds(tick_ns), m_origin);
+    if (wheel->Initialize(func))
+    {
+        delete wheel;
+        return nullptr;
+    }
+    m_wheels.push_back(std::unique_ptr<CTimerWheel>(wheel));
+    m_live_wheels.insert(wheel);
+
+    return wheel;
+}
+
+CTimerLockerManager::CTimerWheel* CTimerLockerManager::FindWheel(CTimerLocker* item)
+{
+    if (nullptr == item)
+        return nullptr;
+
+    for (std::unique_ptr<CTimerWheel>& wheel : m_wheels)
+    {
+        if (wheel->HasItem(item))
+            return wheel.get();
+    }
+
+    return nullptr;
+}
+
+// 비어 있는 wheel 은 제거하고, CTimerLocker 가 제거된 wheel 은 base tick 을 다시 계산 한다.
+void CTimerLockerManager::PlanWheels()
+{
+    if (m_dispatching_wheel)
+        return;
+
+    auto it = m_wheels.begin();
+    while (it != m_wheels.end())
+    {
+        CTimerWheel* wheel = it->get();
+        if (wheel->IsEmpty())
+        {
+            m_live_wheels.erase(wheel);
+            it = m_wheels.erase(it);
+            continue;
+        }
+
+        if (wheel->NeedPlan())
+            wheel->SetTick(wheel->GetPlannedTick());
+        it++;
+    }
+}
+
+double CTimerLockerManager::GetWakeupRate()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    double rate = 0;
+    for (std::unique_ptr<CTimerWheel>& wheel : m_wheels)
+        rate += (double)ONE_SEC_TO_NSEC / wheel->GetTickNs();
+
+    return rate;
+}
+
+size_t CTimerLockerManager::GetTimerWheelCount()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    return m_wheels.size();
+}
+
+CTimerLocker* CTimerLockerManager::GetTimerLockerByTime(const std::string& name, int ms, const CallBackTimer& callback)
+{
+    return GetTimerLockerByTime(name, std::chrono::milliseconds(ms), callback);
+}
+
+CTimerLocker* CTimerLockerManager::GetTimerLockerByTime(const std::string& name, std::chrono::nanoseconds period, const CallBackTimer& callback)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    TimerLockerHandle handle = 0;
+    if (AddTimerLocker(handle, name, period, callback))
+        return nullptr;
+
+    return GetTimerLocker(handle);
+}
+
+int CTimerLockerManager::AddTimerLocker(TimerLockerHandle& handle, const std::string& name, std::chrono::nanoseconds period, const CallBackTimer& callback)
+{
+    return CreateTimerLocker(handle, name, period.count(), 1, -1, callback);
+}
+
+int CTimerLockerManager::AddTimerLockerByFps(TimerLockerHandle& handle, const std::string& name, long long fps_num, long long fps_den, const CallBackTimer& callback)
+{
+    if (fps_num <= 0 || fps_den <= 0)
+        return 5;
+    if (fps_den > LLONG_MAX / ONE_SEC_TO_NSEC)   // 주기의 분자가 long long 을 넘는다.
+        return 6;
+
+    // 주기 = 10^9 * fps_den / fps_num (ns)
+    return CreateTimerLocker(handle, name, ONE_SEC_TO_NSEC * fps_den, fps_num, -1, callback);
+}
+
+int CTimerLockerManager::AddTimerLocker(TimerLockerHandle& handle, const std::string& name, std::chrono::nanoseconds period, std::chrono::nanoseconds phase, const CallBackTimer& callback)
+{
+    if (phase.count() < 0)
+        return 4;
+
+    return CreateTimerLocker(handle, name, period.count(), 1, phase.count(), callback);
+}
+
+// 주기는 period_num / period_den (ns) 이다.
+// phase 가 음수이면 위상을 지정하지 않고 현재 시간 이후의 tick 경계에서 시작 한다.
+int CTimerLockerManager::CreateTimerLocker(TimerLockerHandle& handle, const std::string& name, long long period_num, long long period_den, long long phase, const CallBackTimer& callback)
+{
+    long long divisor = GetGcd(period_num, period_den);
+    if (divisor > 1)
+    {
+        period_num /= divisor;
+        period_den /= divisor;
+    }
+
+    std::chrono::nanoseconds period(period_num / period_den);
+    if (period < GetTimerMinResolutionNs())
+    {
+        period     = GetTimerMinResolutionNs();
+        period_num = period.count();
+        period_den = 1;
+    }
+
+    // 위상이 있으면 base tick 은 주기와 위상의 최대공약수를 넘을 수 없다.
+    // 분수 주기는 최소 해상도의 tick 위에서 정확한 deadline 이후의 첫 tick 에 호출 된다. (10 ms 해상도에서 30 fps 는 40/30/30 ms)
+    long long max_tick = 1 == period_den ? period.count() : GetTimerMinResolutionNs().count();
+    if (phase >= 0 && 1 != period_den)
+        return 4;
+    if (phase >= 0)
+    {
+        phase %= period.count();
+        max_tick = GetGcd(period.count(), phase);
+        if (max_tick < GetTimerMinResolutionNs().count())
+            return 3;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    if (name.size())
+        DeleteTimerLocker(name);  // 기존 Item 이 있다면 제거 한다.
+
+    CTimerWheel* wheel = GetWheel(max_tick);
+    if (nullptr == wheel)
+        return 1;
+    if (false == wheel->HasTimer())
+        return 2;
+
+    CTimerLocker* item = new CTimerLocker(name, period, callback);
+    item->m_handle     = ++m_locker_handle;
+    item->m_period_num = period_num;
+    item->m_period_den = period_den;
+    wheel->AddPeriodItem(item, GetTimerNow(), phase);
+
+    m_map_handles[item->m_handle] = item;
+    if (name.size())
+        m_map_names[name] = item;
+
+    handle = item->m_handle;
+
+    return 0;
+}
+
+CTimerLocker* CTimerLockerManager::GetTimerLocker(TimerLockerHandle handle)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    auto it = m_map_handles.find(handle);
+    if (it == m_map_handles.end())
+        return nullptr;
+
+    return it->second;
+}
+
+CTimerLocker* CTimerLockerManager::GetTimerLocker(const std::string& name)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    auto it = m_map_names.find(name);
+    if (it == m_map_names.end())
+        return nullptr;
+
+    return it->second;
+}
+
+bool CTimerLockerManager::DeleteTimerLocker(TimerLockerHandle handle)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    auto it = m_map_handles.find(handle);
+    if (it == m_map_handles.end())
+        return false;
+
+    CTimerLocker* item = it->second;
+    m_map_handles.erase(it);
+
+    auto it_name = m_map_names.find(item->m_name);
+    if (it_name != m_map_names.end() && it_name->second == item)
+        m_map_names.erase(it_name);
+
+    return RemoveTimerLocker(item);
+}
+
+CTimerLocker* CTimerLockerManager::GetTimerLockerByFps(const std::string& name, int fps, const CallBackTimer& callback)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    TimerLockerHandle handle = 0;
+    if (AddTimerLockerByFps(handle, name, fps, 1, callback))
+        return nullptr;
+
+    return GetTimerLocker(handle);
+}
+
+CTimerLocker* CTimerLockerManager::GetTimerLockerByFps(const std::string& name, double fps, const CallBackTimer& callback)
+{
+    if (false == (fps > 0))
+        return nullptr;
+
+    // 정수 FPS 가 아니면 NTSC 규격 (N * 1000 / 1001, 29.97 = 30000/1001) 인지 먼저 확인하고
+    // 아니면 천분의 1, 백만분의 1 단위의 분수로 변환 한다.
+    long long fps_num = (long long)std::round(fps);
+    long long fps_den = 1;
+    if (std::fabs(fps_num - fps) > fps * 1e-9)
+    {
+        double ntsc = fps * 1.001;
+        if (std::round(ntsc) > 0 && std::fabs(std::round(ntsc) - ntsc) < 1e-4)
+        {
+            fps_num = (long long)std::round(ntsc) * 1000;
+            fps_den = 1001;
+        }
+        else
+        {
+            fps_den = std::fabs(std::round(fps * 1000) / 1000 - fps) <= fps * 1e-9 ? 1000 : 1000000;
+            fps_num = (long long)std::round(fps * fps_den);
+        }
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    TimerLockerHandle handle = 0;
+    if (AddTimerLockerByFps(handle, name, fps_num, fps_den, callback))
+        return nullptr;
+
+    return GetTimerLocker(handle);
+}
+
+bool CTimerLockerManager::DeleteTimerLocker(CTimerLocker* timer_locker)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    if (nullptr == timer_locker)
+        return false;
+
+    return DeleteTimerLocker(timer_locker->m_handle);
+}
+
+bool CTimerLockerManager::DeleteTimerLocker(const std::string& name)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    CTimerLocker* item = GetTimerLocker(name);
+    if (nullptr == item)
+        return false;
+
+    return DeleteTimerLocker(item->m_handle);
+}
+
+// 목록 (index) 과 관계 없이 Timing wheel 에서 CTimerLocker 를 제거 한다.
+bool CTimerLockerManager::RemoveTimerLocker(CTimerLocker* item)
+{
+    CTimerWheel* wheel = FindWheel(item);
+    if (nullptr == wheel)
+        return false;
+
+    if (false == wheel->DeleteItem(item))
+        return false;
+
+    // 모든 아이템을 제거한 wheel 은 존재해야할 필요가 없기 때문에 삭제하고, 남은 wheel 은 base tick 을 다시 계산 한다.
+    PlanWheels();
+
+    return true;
+}
+
+bool CTimerLockerManager::SetTimerLockerSlack(CTimerLocker* timer_locker, std::chrono::nanoseconds slack)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    if (nullptr == timer_locker)
+        return false;
+
+    timer_locker->m_slack = slack.count() > 0 ? slack : std::chrono::nanoseconds(0);
+
+    return true;
+}
+
+bool CTimerLockerManager::SetTimerLockerOverrunPolicy(CTimerLocker* timer_locker, CTimerLocker::OverrunPolicy policy)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    if (nullptr == timer_locker)
+        return false;
+
+    timer_locker->m_overrun_policy = policy;
+
+    return true;
+}
+
+int CTimerLockerManager::GetLoadHistogram(const std::vector<CTimerLocker*>& lockers, std::chrono::nanoseconds window, std::vector<int>& histogram)
+{
+    long long bucket = GetTimerMinResolutionNs().count();
+    if (window.count() < bucket)
+        return 1;
+
+    long long bucket_count = (window.count() + bucket - 1) / bucket;
+    if (bucket_count > 1000000)
+        return 2;
+
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    std::vector<CTimerLocker*> items;
+    if (lockers.empty())
+    {
+        for (auto it = m_map_handles.begin(); it != m_map_handles.end(); it++)
+            items.push_back(it->second);
+    }
+    else
+    {
+        for (CTimerLocker* locker : lockers)
+        {
+            if (locker && GetTimerLocker(locker->m_handle) == locker)
+                items.push_back(locker);
+        }
+    }
+
+    // 다음 deadline 부터 window 시간 동안의 deadline 을 m_origin 기준 window 로 접어서 bucket 별로 센다.
+    histogram.assign((size_t)bucket_count, 0);
+    for (CTimerLocker* item : items)
+    {
+        long long start    = std::chrono::duration_cast<std::chrono::nanoseconds>(item->m_start - m_origin).count();
+        long long deadline = start + item->GetFireOffset(item->m_fire_index).count();
+        for (long long index = item->m_fire_index; ; index++)
+        {
+            long long time = start + item->GetFireOffset(index).count();
+            if (time >= deadline + window.count())
+                break;
+
+            long long offset = time % window.count();
+            if (offset < 0)
+                offset += window.count();
+            histogram[(size_t)(offset / bucket)]++;
+        }
+    }
+
+    return 0;
+}
+
+long long CTimerLockerManager::GetOverrunTickCount() const
+{
+    return m_overrun_ticks.load();
+}
+
+int CTimerLockerManager::AddBatchCallback(const CallBackBatch& callback)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    int id = ++m_batch_callback_id;
+    m_map_batch_callbacks[id] = callback;
+    UpdateBatchCallbacks();
+
+    return id;
+}
+
+bool CTimerLockerManager::DeleteBatchCallback(int id)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    if (0 == m_map_batch_callbacks.erase(id))
+        return false;
+
+    UpdateBatchCallbacks();
+    return true;
+}
+
+// 실행 중인 executor 작업에 영향을 주지 않도록 변경될 때마다 새로운 복사본을 만든다.
+void CTimerLockerManager::UpdateBatchCallbacks()
+{
+    std::shared_ptr<std::vector<CallBackBatch>> batch_callbacks = std::make_shared<std::vector<CallBackBatch>>();
+    for (auto it = m_map_batch_callbacks.begin(); it != m_map_batch_callbacks.end(); it++)
+        batch_callbacks->push_back(it->second);
+
+    m_batch_callbacks = batch_callbacks;
+}
+
+int CTimerLockerManager::AddTimerTask(TimerTaskId& id, std::chrono::steady_clock::time_point deadline, const CallBackTimer& callback)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    // Timer task 는 최소 해상도의 정밀도로 호출 되어야 한다.
+    CTimerWheel* wheel = GetTaskWheel(deadline);
+    if (nullptr == wheel)
+        return 1;
+    if (false == wheel->HasTimer())
+        return 2;
+
+    id = ++m_task_id;
+
+    // 호출되는 시점에 목록에서 제거 한다. callback 안에서 DeleteTimerTask() 를 호출해도 문제가 없다.
+    // executor 에서 호출되는 경우 이미 취소되어 목록에 없으면 호출하지 않는다.
+    TimerTaskId task_id = id;
+    auto func = [this, task_id, callback](const CTimerLocker& locker) {
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+            if (0 == m_map_tasks.erase(task_id))
+                return;
+        }
+        if (callback)
+            callback(locker);
+    };
+
+    CTimerLocker* item = new CTimerLocker(std::string(), std::chrono::nanoseconds(0), func);
+    item->m_one_shot   = true;
+    item->m_max_tick   = wheel->GetTickNs();   // 배치된 wheel 의 base tick 을 바꾸지 않는다.
+    item->m_start      = deadline;
+    item->m_fire_index = 0;
+    wheel->AddItem(item);
+
+    m_map_tasks[id] = item;
+
+    return 0;
+}
+
+bool CTimerLockerManager::DeleteTimerTask(TimerTaskId id)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex_items);
+
+    auto it = m_map_tasks.find(id);
+    if (it == m_map_tasks.end())
+        return false;
+
+    CTimerLocker* item = it->second;
+    m_map_tasks.erase(it);
+
+    // executor 로 전달되어 wheel 에서는 빠졌지만 아직 호출되지 않은 task 는 목록에서 제거 되었기 때문에 호출되지 않는다.
+    if (false == RemoveTimerLocker(item))
+        item->m_canceled = true;
+
+    return true;
+}
+
+int BenchTimerLockerJitter()
+{
+    typedef std::chrono::steady_clock::time_point   chrono_tp;
+    typedef std::chrono::duration<double, std::micro> chrono_duration_micro;
+
+    CTimerLockerManager& manager = CTimerLockerManager::GetInstance();
+    std::chrono::nanoseconds old_resolution = manager.GetTimerMinResolutionNs();
+
+    const std::chrono::nanoseconds resolutions[] = {
+        std::chrono::milliseconds(10),
+        std::chrono::milliseconds(1),
+        std::chrono::microseconds(500),
+        std::chrono::microseconds(100),
+    };
+
+    printf("%12s %10s %12s %12s %12s %12s\n", "period(us)", "samples", "mean(us)", "stddev(us)", "p99(us)", "max(us)");
+    for (std::chrono::nanoseconds resolution : resolutions)
+    {
+        // 1초 동안 측정 한다.
+        size_t sample_count = (size_t)(std::chrono::seconds(1) / resolution);
+
+        std::mutex          mutex;
+        std::vector<double> jitters;
+        chrono_tp           last;
+        bool                first = true;
+        jitters.reserve(sample_count);
+
+        manager.SetTimerMinResolution(resolution);
+
+        double period_us = chrono_duration_micro(resolution).count();
+        auto func = [&](const CTimerLocker&) {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            chrono_tp now = std::chrono::steady_clock::now();
+            if (false == first && jitters.size() < sample_count)
+                jitters.push_back(chrono_duration_micro(now - last).count() - period_us);
+            last  = now;
+            first = false;
+        };
+
+        CTimerLocker* locker = manager.GetTimerLockerByTime("bench_jitter", resolution, func);
+        if (nullptr == locker)
+        {
+            manager.SetTimerMinResolution(old_resolution);
+            return 1;
+        }
+
+        std::this_thread::sleep_for(std::chrono::seconds(1) + std::chrono::milliseconds(100));
+        manager.DeleteTimerLocker(locker);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (jitters.empty())
+            continue;
+
+        double sum = 0, sum_sq = 0;
+        for (double jitter : jitters)
+        {
+            sum    += jitter;
+            sum_sq += jitter * jitter;
+        }
+        double mean   = sum / jitters.size();
+        double stddev = std::sqrt(std::max(0.0, sum_sq / jitters.size() - mean * mean));
+
+        std::vector<double> abs_jitters;
+        for (double jitter : jitters)
+            abs_jitters.push_back(std::abs(jitter));
+        std::sort(abs_jitters.begin(), abs_jitters.end());
+        double p99 = abs_jitters[(size_t)((abs_jitters.size() - 1) * 0.99)];
+
+        printf("%12.1f %10zu %12.2f %12.2f %12.2f %12.2f\n", period_us, jitters.size(), mean, stddev, p99, abs_jitters.back());
+    }
+
+    manager.SetTimerMinResolution(old_resolution);
+
+    return 0;
+}
+
+int BenchTimerLockerTick()
+{
+    typedef std::chrono::steady_clock chrono_clock;
+
+    // CTimerLocker 와 같은 크기의 객체를 하나씩 할당하여 pointer 를 따라가는 기존 방식을 흉내 낸다.
+    struct LockerAoS
+    {
+        long long   expire_tick;
+        char        padding[sizeof(CTimerLocker) - sizeof(long long)];
+    };
+
+    const size_t counts[] = { 1000, 10000, 100000 };
+    const size_t total    = 20000000;   // 측정 마다 비교하는 전체 item 수
+
+    std::mt19937_64 random(20190715);
+
+    printf("%10s %16s %16s %16s\n", "lockers", "aos(ns/tick)", "scalar(ns/tick)", "simd(ns/tick)");
+    for (size_t count : counts)
+    {
+        std::vector<std::unique_ptr<LockerAoS>> objects;
+        std::vector<LockerAoS*>                 items;
+        std::vector<long long>                  expire_ticks;
+        for (size_t ii = 0; ii < count; ii++)
+        {
+            objects.push_back(std::unique_ptr<LockerAoS>(new LockerAoS));
+            objects.back()->expire_tick = (long long)(random() % 1024);
+        }
+        std::shuffle(objects.begin(), objects.end(), random);   // 할당 순서와 다르게 접근 한다.
+        for (std::unique_ptr<LockerAoS>& object : objects)
+        {
+            items.push_back(object.get());
+            expire_ticks.push_back(object->expire_tick);
+        }
+
+        std::vector<uint64_t> mask((count + 63) / 64);
+        size_t   rounds = total / count;
+        uint64_t check  = 0;
+
+        auto measure = [&](int type) {
+            chrono_clock::time_point start = chrono_clock::now();
+            for (size_t round = 0; round < rounds; round++)
+            {
+                long long tick = (long long)(round % 1024);
+                std::fill(mask.begin(), mask.end(), 0);
+                if (0 == type)
+                {
+                    for (size_t ii = 0; ii < count; ii++)
+                    {
+                        if (items[ii]->expire_tick <= tick)
+                            mask[ii / 64] |= (uint64_t)1 << (ii % 64);
+                    }
+                }
+                else if (1 == type)
+                {
+                    GetDueMaskScalar(expire_ticks.data(), count, tick, mask.data());
+                }
+                else
+                {
+                    GetDueMask(expire_ticks.data(), count, tick, mask.data());
+                }
+                check += mask[0] + mask.back();
+            }
+            return std::chrono::duration<double, std::nano>(chrono_clock::now() - start).count() / rounds;
+        };
+
+        double aos    = measure(0);
+        double scalar = measure(1);
+        double simd   = measure(2);
+        printf("%10zu %16.1f %16.1f %16.1f\n", count, aos, scalar, simd);
+
+        if (0 == check)     // 최적화로 측정 코드가 제거되지 않도록 사용 한다.
+            printf("\n");
+    }
+
+    return 0;
+}
+
+int TestTimerLockerFps()
+{
+    typedef std::chrono::steady_clock::time_point chrono_tp;
+
+    enum
+    {
+        FIRE_COUNT = 31,
+    };
+
+    CTimerLockerManager& manager = CTimerLockerManager::GetInstance();
+    if (timer_ex::AdvanceVirtualTimer(std::chrono::nanoseconds(0)))
+    {
+        printf("Virtual timer 로 초기화 되어 있지 않습니다.\n");
+        return 1;
+    }
+
+    std::chrono::nanoseconds resolution = manager.GetTimerMinResolutionNs();
+
+    // 최소 해상도 별로 30 fps 의 간격은 short_ms 또는 short_ms + tick 이고 연속된 3 개의 합은 정확히 100 ms 이다.
+    // base tick 은 최소 해상도 이므로 초당 wakeup 수는 1000 / tick_ms 이다.
+    struct Case
+    {
+        int tick_ms;
+        int short_ms;
+    };
+    const Case cases[] = { { 1, 33 }, { 10, 30 } };
+
+    int result = 0;
+    for (const Case& test : cases)
+    {
+        manager.SetTimerMinResolution(test.tick_ms);
+
+        std::vector<chrono_tp> fires;
+        auto func = [&fires, &manager](const CTimerLocker&) {
+            fires.push_back(manager.GetTime());
+        };
+
+        CTimerLocker* locker = manager.GetTimerLockerByFps("test_fps_30", 30, func);
+        if (nullptr == locker)
+        {
+            result = 2;
+            break;
+        }
+        double wakeup_rate = manager.GetWakeupRate();
+
+        while (fires.size() < FIRE_COUNT)
+            timer_ex::AdvanceVirtualTimer(std::chrono::milliseconds(1));
+        manager.DeleteTimerLocker(locker);
+
+        int case_result = 0;
+        if (std::fabs(wakeup_rate - 1000.0 / test.tick_ms) > 0.5)
+            case_result = 5;
+
+        printf("tick %2d ms, wakeup %.0f/s : ", test.tick_ms, wakeup_rate);
+        for (size_t index = 1; index < fires.size(); index++)
+        {
+            long long interval = std::chrono::duration_cast<std::chrono::milliseconds>(fires[index] - fires[index - 1]).count();
+            printf("%lld ", interval);
+            if (interval != test.short_ms && interval != test.short_ms + test.tick_ms)
+                case_result = 3;
+            if (index >= 3 && std::chrono::milliseconds(100) != fires[index] - fires[index - 3])
+                case_result = 4;
+        }
+        printf(": %s\n", case_result ? "FAIL" : "OK");
+
+        if (case_result)
+            result = case_result;
+    }
+
+    manager.SetTimerMinResolution(resolution);
+
+    return result;
+}
@@ -5,11 +5,19 @@
 ///  @author  Lee Jong Oh
 ///  @brief   일정 시간 마다 Event signal 을 발생하는 객체를 생성하고 사용 한다.
 
+#include <string>
+#include <memory>
 #include <map>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
 #include <mutex>
+#include <atomic>
+#include <chrono>
 #include <functional>
 
 #include "Locker.h"
+#include "TimerStats.h"
 
 //////////////////////////////////////////////////////////////////////////
 ///  @class   CTimerLocker
@@ -19,22 +27,70 @@ class CTimerLocker : public Locker
 {
     friend class CTimerLockerManager;
 
+public:
+    ///  @brief   시스템 지연으로 deadline 을 놓친 경우의 처리 방법
+    enum OverrunPolicy
+    {
+        OVERRUN_SKIP  = 0,      // 누락된 주기는 건너뛰고 한번만 event 를 전송 한다. (기본값)
+        OVERRUN_BURST = 1,      // 누락된 주기만큼 event 를 연속으로 전송 한다.
+    };
+
+    using Handle = long long;   // CTimerLockerManager 에서 CTimerLocker 를 식별하는 값, 0 은 유효하지 않다.
+
 private:
     using CallBackTimer = std::function<void(const CTimerLocker& locker)>;
+    using Clock         = std::chrono::steady_clock;
+    using TimePoint     = Clock::time_point;
+    using Duration      = std::chrono::nanoseconds;
 
     std::string     m_name;
-    int             m_period = 0;
-    int             m_period_count = 0;
+    Handle          m_handle = 0;
+    Duration        m_period;
+    long long       m_period_num = 0;       // 정확한 주기 = m_period_num / m_period_den (ns), m_period 는 소수점 이하를 버린 값
+    long long       m_period_den = 1;
+    Duration        m_slack{ 0 };           // deadline 이후로 지연을 허용하는 시간
+    OverrunPolicy   m_overrun_policy = OVERRUN_SKIP;
+    int             m_missed_count   = 0;   // 마지막 event 에서 누락된 주기 수
+
+    bool            m_one_shot = false;     // true 이면 m_start 에 한번만 event 를 받고 제거 된다.
+    TimePoint       m_start;                // 절대 deadline 의 기준 시간 (monotonic clock)
+    long long       m_fire_index = 0;       // 다음 deadline = m_start + m_fire_index * period
+
+    std::atomic<long long>  m_drift{ 0 };       // 마지막 event 의 deadline 대비 오차 (ns)
+    std::atomic<long long>  m_max_drift{ 0 };   // 측정된 오차 중에서 가장 큰 값 (ns)
+    std::atomic<long long>  m_last_deadline{ 0 };   // 마지막 event 의 deadline (clock 의 epoch 기준 ns)
+    std::atomic<long long>  m_event_count{ 0 };     // 전송한 event 수
+    std::unique_ptr<CTimerStats>    m_stats;    // 호출 간격, 지연 histogram (주기 CTimerLocker 만 사용)
+
+    long long       m_max_tick    = 0;      // 허용하는 base tick 의 최대값 (주기와 시작 위상의 최대공약수, ns)
+    long long       m_expire_tick = 0;      // Timing wheel 에서 다음 event 를 받을 tick
+    size_t          m_wheel_slot  = 0;      // Timing wheel 의 slot 위치
+    size_t          m_wheel_pos   = 0;      // slot 내부의 위치
+    size_t          m_owner_pos   = 0;      // 소유하고 있는 목록 내부의 위치
 
     CallBackTimer   m_callback;
 
+    // DISPATCH_EXECUTOR 에서 executor 로 전달된 callback 의 상태
+    std::atomic<bool>   m_canceled{ false };    // 제거되어 대기 중인 callback 을 호출하지 않는다.
+    std::atomic<bool>   m_queued{ false };      // callback 이 executor 에 전달 되었거나 실행 중
+    std::atomic<int>    m_queued_fires{ 0 };    // 호출해야 할 callback 수
+    std::atomic<int>    m_queued_missed{ 0 };   // 누락된 주기 수
+    std::atomic<int>    m_jobs{ 0 };            // 이 객체를 참조하는 executor 작업 수, 0 이 될 때까지 해제하지 않는다.
+
 private:
-    CTimerLocker(const std::string& name, int period);
-    CTimerLocker(const std::string& name, int period, const CallBackTimer& callback);
+    CTimerLocker(const std::string& name, Duration period);
+    CTimerLocker(const std::string& name, Duration period, const CallBackTimer& callback);
 
     // [주의사항] Callback 함수에서는 오래 걸리는 작업을 수행하면 안된다.
     void SetCallback(const CallBackTimer& callback);
 
+    TimePoint GetDeadline() const;
+    Duration  GetFireOffset(long long fire_index) const;
+    long long GetFireIndex(const TimePoint& time) const;
+    void      UpdateDrift(const TimePoint& now);
+    bool      QueueCallback(int missed_count);
+    bool      RunQueuedCallback();
+
 public:
     ~CTimerLocker();
 
@@ -42,39 +98,143 @@ public:
     ///  @return : 설정된 식별자 name 을 리턴
     std::string GetName() const;
 
+    ///  @brief : CTimerLockerManager 에서 발급한 handle 을 반환 한다.
+    ///  @return : handle, Timer task 이면 0
+    Handle GetHandle() const;
+
     ///  @brief : 설정된 타이머 시간(ms) 을 반환 한다.
     ///  @return : 타이머 시간 반환
     int  GetPeriod() const;
 
+    ///  @brief : 설정된 타이머 시간을 nanosecond 단위로 반환 한다.
+    ///           분수 주기 (AddTimerLockerByFps) 이면 소수점 이하를 버린 값이며 실제 deadline 은 정확한 주기로 계산 된다.
+    ///  @return : 타이머 시간 반환
+    std::chrono::nanoseconds GetPeriodNs() const;
+
+    ///  @brief : 설정된 초당 event 수를 소수점 까지 반환 한다.
+    ///  @return : 초당 event 수 (예: 30000/1001 fps 이면 29.97...), 한번만 호출되는 Timer task 이면 0
+    double GetRate() const;
+
+    ///  @brief : 시작 이후 전송한 event 수와 지금까지 지나간 deadline 수의 차이를 반환 한다.
+    ///           0 이면 정확한 비율로 전송 되었으며, 누락된 주기를 건너뛰면 (OVERRUN_SKIP) 음수가 된다.
+    ///           deadline 이 지나고 event 가 전송되기 전에 호출하면 일시적으로 -1 이 될 수 있다.
+    ///  @return : 누적 frame 오차 (event 수), 한번만 호출되는 Timer task 이면 0
+    long long GetFrameError() const;
+
+    ///  @brief : 마지막 event 를 전송할 때 누락된 주기 수를 반환 한다. callback 안에서 사용 한다.
+    ///           OVERRUN_BURST 인 경우 연속으로 전송되는 event 모두 같은 값을 반환 한다.
+    ///           DISPATCH_EXECUTOR 에서 executor 가 늦어져 합쳐진 event 도 누락된 주기로 계산 된다.
+    ///  @return : 누락된 주기 수, 정상적으로 호출 되었으면 0
+    int  GetMissedCount() const;
+
+    ///  @brief : 설정된 Overrun 처리 방법을 반환 한다.
+    ///  @return : OverrunPolicy
+    OverrunPolicy GetOverrunPolicy() const;
+
+    ///  @brief : 설정된 slack 시간을 반환 한다.
+    ///  @return : slack 시간
+    std::chrono::nanoseconds GetSlack() const;
+
     ///  @brief : 설정된 FPS 을 반환 한다.
     ///  @return : FPS 반환
     int  GetFps() const;
+
+    ///  @brief : 마지막 event 가 절대 deadline (시작 시간 + k * 주기) 에서 벗어난 시간을 반환 한다.
+    ///           deadline 은 누적되지 않기 때문에 장시간 동작하더라도 값이 커지지 않아야 한다.
+    ///  @return : 오차 (millisecond), 늦으면 양수
+    double GetDrift() const;
+
+    ///  @brief : 측정된 오차 중에서 절대값이 가장 큰 값을 반환 한다.
+    ///  @return : 오차 (millisecond), 늦으면 양수
+    double GetMaxDrift() const;
+
+    ///  @brief : 마지막 event 의 deadline 을 반환 한다. callback 안에서 사용 한다.
+    ///  @return : deadline, CTimerLockerManager::GetTime() 과 같은 clock
+    std::chrono::steady_clock::time_point GetLastDeadline() const;
+
+    ///  @brief : event 의 실제 간격, deadline 대비 지연 histogram 과 실제 FPS 를 반환 한다.
+    ///           Timer 처리 중에 lock 없이 기록되며 언제든 호출할 수 있다.
+    ///  @param stats[out] : 통계
+    ///  @return : 성공 시에 0, 통계가 없는 Timer task 이면 1
+    int  GetStats(TimerStats& stats) const;
+
+    ///  @brief : 통계를 초기화 한다.
+    void ResetStats();
 };
 
 //////////////////////////////////////////////////////////////////////////
 ///  @class   CTimerLockerManager
 ///  @brief   CTimerLocker 를 관리하고 Timer 를 통해서 Event 를 발생시켜 signal 을 전송해주는 class
+///           CTimerLocker 들은 Hashed timing wheel 로 묶여서 처리되며 wheel 마다 하나의 OS Timer(base tick) 를 사용 한다.
+///           base tick 은 wheel 에 속한 주기들의 최대공약수로 정하고 초당 wakeup 수가 가장 적어지는 wheel 에 배치 한다.
+///           가상 시간으로 동작 시키려면 GetInstance() 보다 먼저 timer_ex::InitializeVirtualTimer() 를 호출 한다.
 ///           singleton 으로 구현되어 있음
 
 class CTimerLockerManager
 {
+public:
+    using TimerTaskId       = long long;
+    using TimerLockerHandle = CTimerLocker::Handle;
+    using Executor          = std::function<void(const std::function<void()>& job)>;
+
+    ///  @brief   CTimerLocker callback 을 호출하는 방법
+    enum DispatchMode
+    {
+        DISPATCH_INLINE   = 0,  // Timer 처리 중에 바로 호출 한다. (기본값)
+        DISPATCH_EXECUTOR = 1,  // Timer 는 만료된 CTimerLocker 만 표시하고 callback 은 executor 에서 호출 한다.
+    };
+
 private:
-    class CTimerLockerList;
+    class CTimerWheel;
+    class CDispatchThread;
     using CallBackTimer = CTimerLocker::CallBackTimer;
+    using CallBackBatch = std::function<void()>;
 
-    int    m_timer_min_resolution = 10;
+    std::chrono::nanoseconds                m_timer_min_resolution = std::chrono::milliseconds(10);
+    std::chrono::steady_clock::time_point   m_origin;   // 모든 Timing wheel 의 tick 0, CTimerLocker 위상의 기준 시간
 
-    std::recursive_mutex    m_mutex_items;
-    std::map<int, std::unique_ptr<CTimerLockerList>>    m_map_timers;   // key : period(ms), value : CTimerList
+    std::recursive_mutex                        m_mutex_items;
+    std::vector<std::unique_ptr<CTimerWheel>>   m_wheels;   // base tick 별로 CTimerLocker 를 처리하는 Timing wheel
+    std::unordered_set<CTimerWheel*>            m_live_wheels;  // OS Timer callback 의 ptr 이 아직 해제되지 않은 wheel 인지 확인
+    CTimerWheel*                                m_dispatching_wheel = nullptr;  // event 를 전송 중인 Timing wheel
+    std::atomic<long long>          m_overrun_ticks{ 0 };       // OS Timer 에서 누락된 tick 수
+
+    TimerLockerHandle                                           m_locker_handle = 0;
+    std::unordered_map<TimerLockerHandle, CTimerLocker*>        m_map_handles;  // handle 로 CTimerLocker 를 찾는 index
+    std::unordered_map<std::string, CTimerLocker*>              m_map_names;    // name 으로 CTimerLocker 를 찾는 index
+
+    TimerTaskId                                         m_task_id = 0;
+    std::unordered_map<TimerTaskId, CTimerLocker*>      m_map_tasks;    // 한번만 호출되는 Timer task
+
+    int                             m_batch_callback_id = 0;
+    std::map<int, CallBackBatch>    m_map_batch_callbacks;
+    std::shared_ptr<const std::vector<CallBackBatch>>   m_batch_callbacks;  // executor 작업에서 사용하는 batch callback 의 복사본
+
+    DispatchMode                        m_dispatch_mode = DISPATCH_INLINE;
+    Executor                            m_executor;
+    std::unique_ptr<CDispatchThread>    m_dispatch_thread;  // executor 를 지정하지 않았을 때 사용하는 thread
+
+    std::mutex                                  m_mutex_retired;
+    std::vector<std::unique_ptr<CTimerLocker>>  m_retired_lockers;  // 제거 되었지만 executor 작업이 참조하고 있는 CTimerLocker
+    std::atomic<size_t>                         m_retired_count{ 0 };
 
 private:
     CTimerLockerManager();
     ~CTimerLockerManager();
 
-    CTimerLockerList* GetList(int ms);
-    int  GetDivisor(int ms);
+    CTimerWheel* GetWheel(long long max_tick);
+    CTimerWheel* GetTaskWheel(const CTimerLocker::TimePoint& deadline);
+    CTimerWheel* CreateWheel(long long tick_ns);
+    CTimerWheel* FindWheel(CTimerLocker* item);
+    bool         RemoveTimerLocker(CTimerLocker* item);
+    int          CreateTimerLocker(TimerLockerHandle& handle, const std::string& name, long long period_num, long long period_den, long long phase, const CallBackTimer& callback);
+    void         PlanWheels();
+    void         RetireLocker(std::unique_ptr<CTimerLocker> item);
+    void         ReclaimLockers();
+    void         RunTimerLocker(CTimerLocker* item);
+    void         UpdateBatchCallbacks();
 
-    void CallbackTimer(int id, int ms);
+    void CallbackTimer(CTimerWheel* wheel, int id, int expirations);
 
 public:
     ///  @brief      싱글턴 패턴으로 구현되어 있다.
@@ -86,12 +246,65 @@ public:
     }
 
     ///  @brief : 타이머의 최소 해상도를 설정 한다.
+    ///           Timing wheel 의 base tick 은 이 값보다 작아지지 않으며 Timer task 의 정밀도로 사용 된다.
+    ///           변경된 값은 이후에 추가되는 CTimerLocker 부터 적용 된다.
     ///  @param ms[in] : 시간 설정 (millisecond)
     ///  @return : 없음
     void SetTimerMinResolution(int ms);
+    ///  @brief : 타이머의 최소 해상도를 nanosecond 단위로 설정 한다. 100 us 보다 작은 값은 100 us 로 설정 된다.
+    ///           1 ms 미만의 주기를 사용하려면 해상도를 그 주기 이하로 낮춰야 한다.
+    ///  @param resolution[in] : 시간 설정
+    ///  @return : 없음
+    void SetTimerMinResolution(std::chrono::nanoseconds resolution);
     ///  @brief : 타이머의 최소 해상도를 반환 한다.
-    ///  @return : 타이머의 최소 해상도
+    ///  @return : 타이머의 최소 해상도 (millisecond)
     int  GetTimerMinResolution() const;
+    ///  @brief : 타이머의 최소 해상도를 nanosecond 단위로 반환 한다.
+    ///  @return : 타이머의 최소 해상도
+    std::chrono::nanoseconds GetTimerMinResolutionNs() const;
+
+    ///  @brief : Timer 가 사용하는 monotonic clock 의 현재 시간을 반환 한다.
+    ///           timer_ex::InitializeVirtualTimer() 로 초기화 되어 있으면 가상 시간을 반환 한다.
+    ///           AddTimerTask() 의 deadline 은 이 시간을 기준으로 계산 한다.
+    ///  @return : 현재 시간
+    std::chrono::steady_clock::time_point GetTime() const;
+
+    ///  @brief : CTimerLocker 를 생성하고 handle 을 발급 한다. O(1)
+    ///           같은 name 의 CTimerLocker 가 있으면 제거한 후에 생성 한다. name 이 비어 있으면 이름으로 찾을 수 없는 CTimerLocker 가 된다.
+    ///           첫 event 는 기준 시간부터 주기의 배수인 시간에 정렬되기 때문에 최대 1 주기 늦어질 수 있다.
+    ///  @param handle[out] : 생성된 CTimerLocker 의 handle
+    ///  @param name[in] : CTimerLocker 를 식별해주는 이름
+    ///  @param period[in] : 시간 설정 (nanosecond), 최소 해상도 보다 작으면 최소 해상도로 설정 된다.
+    ///  @param callback[in] : 설정된 시간마다 호출되는 callback 함수
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+    int  AddTimerLocker(TimerLockerHandle& handle, const std::string& name, std::chrono::nanoseconds period, const CallBackTimer& callback = CallBackTimer());
+
+    ///  @brief : 위상 (phase) 을 지정하여 CTimerLocker 를 생성하고 handle 을 발급 한다.
+    ///           deadline 은 기준 시간 + phase + k * period 이며 기준 시간은 모든 CTimerLocker 가 같다.
+    ///           같은 주기의 CTimerLocker 들을 서로 다른 tick 으로 분산 시킬 때 사용하며 첫 event 는 최대 1 주기 늦어질 수 있다.
+    ///           base tick 은 주기와 위상의 최대공약수 이하가 되기 때문에 위상은 주기를 2의 거듭제곱으로 나눈 값의 배수를 권장 한다.
+    ///  @param handle[out] : 생성된 CTimerLocker 의 handle
+    ///  @param name[in] : CTimerLocker 를 식별해주는 이름
+    ///  @param period[in] : 시간 설정 (nanosecond), 최소 해상도 보다 작으면 최소 해상도로 설정 된다.
+    ///  @param phase[in] : 위상 (nanosecond), 주기 보다 크면 주기로 나눈 나머지를 사용 한다.
+    ///  @param callback[in] : 설정된 시간마다 호출되는 callback 함수
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴 (주기와 위상의 최대공약수가 최소 해상도 보다 작으면 3)
+    int  AddTimerLocker(TimerLockerHandle& handle, const std::string& name, std::chrono::nanoseconds period, std::chrono::nanoseconds phase, const CallBackTimer& callback);
+
+    ///  @brief : handle 에 해당하는 CTimerLocker 객체를 반환 한다. O(1)
+    ///  @param handle[in] : AddTimerLocker() 에서 얻어온 handle
+    ///  @return : CTimerLocker 객체, 없으면 nullptr
+    CTimerLocker* GetTimerLocker(TimerLockerHandle handle);
+
+    ///  @brief : name 에 해당하는 CTimerLocker 객체를 반환 한다. O(1)
+    ///  @param name[in] : CTimerLocker 를 식별해주는 이름
+    ///  @return : CTimerLocker 객체, 없으면 nullptr
+    CTimerLocker* GetTimerLocker(const std::string& name);
+
+    ///  @brief : handle 에 해당하는 CTimerLocker 객체를 제거 한다. O(1)
+    ///  @param handle[in] : AddTimerLocker() 에서 얻어온 handle
+    ///  @return : 성공 여부
+    bool DeleteTimerLocker(TimerLockerHandle handle);
 
     ///  @brief : CTimerLocker 객체를 반환 한다. 주의 : 반환 받은 객체는 delete 를 하지 말자.
     ///  @param name[in] : CTimerLocker 를 식별해주는 이름
@@ -101,12 +314,42 @@ public:
     CTimerLocker* GetTimerLockerByTime(const std::string& name, int ms, const CallBackTimer& callback = CallBackTimer());
 
     ///  @brief : CTimerLocker 객체를 반환 한다. 주의 : 반환 받은 객체는 delete 를 하지 말자.
+    ///           첫 event 는 기준 시간부터 주기의 배수인 시간에 정렬되기 때문에 최대 1 주기 늦어질 수 있다.
+    ///  @param name[in] : CTimerLocker 를 식별해주는 이름
+    ///  @param period[in] : 시간 설정 (nanosecond), 최소 해상도 보다 작으면 최소 해상도로 설정 된다.
+    ///  @param callback[in] : 설정된 시간마다 호출되는 callback 함수
+    ///  @return : CTimerLocker 객체
+    CTimerLocker* GetTimerLockerByTime(const std::string& name, std::chrono::nanoseconds period, const CallBackTimer& callback = CallBackTimer());
+
+    ///  @brief : 초당 fps_num / fps_den 번 event 를 받는 CTimerLocker 를 생성하고 handle 을 발급 한다.
+    ///           주기가 nanosecond 로 나누어 떨어지지 않으면 k 번째 deadline 을 시작 시간 + k * 10^9 * fps_den / fps_num (ns) 로 계산하기 때문에
+    ///           각 event 는 정확한 deadline 이후의 첫 최소 해상도 tick 에 호출되어 tick 의 배수인 간격이 번갈아 나타나고
+    ///           (10 ms 해상도에서 30 fps 이면 40/30/30 ms, 1 ms 해상도에서는 34/33/33 ms) 장시간 비율은 정확 하다.
+    ///           base tick 은 최소 해상도 이며 간격의 흔들림을 줄이려면 최소 해상도를 낮춘다.
+    ///  @param handle[out] : 생성된 CTimerLocker 의 handle
+    ///  @param name[in] : CTimerLocker 를 식별해주는 이름
+    ///  @param fps_num[in] : 초당 event 수의 분자 (예: 30000)
+    ///  @param fps_den[in] : 초당 event 수의 분모 (예: 1001)
+    ///  @param callback[in] : 설정된 시간마다 호출되는 callback 함수
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴 (fps 가 0 이하이면 5, fps_den 이 10^9 * fps_den 을 표현할 수 없을 만큼 크면 6)
+    int  AddTimerLockerByFps(TimerLockerHandle& handle, const std::string& name, long long fps_num, long long fps_den, const CallBackTimer& callback = CallBackTimer());
+
+    ///  @brief : CTimerLocker 객체를 반환 한다. 주의 : 반환 받은 객체는 delete 를 하지 말자.
+    ///           주기는 1000 / fps ms 로 나누지 않고 정확한 비율로 계산 한다. AddTimerLockerByFps() 참조
     ///  @param name[in] : CTimerLocker 를 식별해주는 이름
     ///  @param fps[in] : FPS 설정
     ///  @param callback[in] : 설정된 시간마다 호출되는 callback 함수
     ///  @return : CTimerLocker 객체
     CTimerLocker* GetTimerLockerByFps(const std::string& name, int fps, const CallBackTimer& callback = CallBackTimer());
 
+    ///  @brief : 소수 FPS (29.97 등) 로 CTimerLocker 객체를 반환 한다. 주의 : 반환 받은 객체는 delete 를 하지 말자.
+    ///           fps 는 정수, NTSC 규격 (N * 1000 / 1001, 29.97 은 30000/1001), 천분의 1, 백만분의 1 단위 분수의 순서로 변환 된다.
+    ///  @param name[in] : CTimerLocker 를 식별해주는 이름
+    ///  @param fps[in] : FPS 설정
+    ///  @param callback[in] : 설정된 시간마다 호출되는 callback 함수
+    ///  @return : CTimerLocker 객체
+    CTimerLocker* GetTimerLockerByFps(const std::string& name, double fps, const CallBackTimer& callback = CallBackTimer());
+
     ///  @brief : GetTimerLockerByTime() 에서 사용한 CTimerLocker 객체를 반환하여 제거 한다.
     ///  @param timer_locker[in] : CTimerLocker 객체
     ///  @return : 성공 여부
@@ -116,8 +359,101 @@ public:
     ///  @param name[in] : CTimerLocker 객체를 식별해주는 name
     ///  @return : 성공 여부
     bool DeleteTimerLocker(const std::string& name);
+
+    ///  @brief : CTimerLocker 의 slack 을 설정 한다. (Linux timerslack 과 같은 개념)
+    ///           event 가 deadline 이후 slack 시간 만큼 늦어지는 것을 허용하며
+    ///           그 범위 안에서 다른 CTimerLocker 와 같은 tick 으로 정렬하여 한번의 batch 로 처리 한다.
+    ///           다음 deadline 부터 적용되며 지연은 누적되지 않는다.
+    ///  @param timer_locker[in] : CTimerLocker 객체
+    ///  @param slack[in] : 허용하는 지연 시간, 0 이면 사용하지 않는다.
+    ///  @return : 성공 여부
+    bool SetTimerLockerSlack(CTimerLocker* timer_locker, std::chrono::nanoseconds slack);
+
+    ///  @brief : CTimerLocker 가 deadline 을 놓쳤을 때의 처리 방법을 설정 한다.
+    ///  @param timer_locker[in] : CTimerLocker 객체
+    ///  @param policy[in] : OVERRUN_SKIP 또는 OVERRUN_BURST
+    ///  @return : 성공 여부
+    bool SetTimerLockerOverrunPolicy(CTimerLocker* timer_locker, CTimerLocker::OverrunPolicy policy);
+
+    ///  @brief : OS Timer 에서 보고된 누락 tick 의 누적 수를 반환 한다.
+    ///           누락된 tick 의 deadline 은 다음 tick 에서 모두 처리 된다.
+    ///  @return : 누락된 tick 수
+    long long GetOverrunTickCount() const;
+
+    ///  @brief : 다음 deadline 부터 window 시간 동안 tick (최소 해상도) 별로 event 를 받는 CTimerLocker 의 수를 구한다.
+    ///           deadline 은 기준 시간으로부터 window 로 나눈 나머지 위치에 집계 되기 때문에 window 를 주기로 하면 위상 별 부하가 된다.
+    ///  @param lockers[in] : 집계할 CTimerLocker 목록, 비어 있으면 모든 CTimerLocker
+    ///  @param window[in] : 집계하는 시간 범위
+    ///  @param histogram[out] : tick 별 event 수, 크기는 window / 최소 해상도
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+    int  GetLoadHistogram(const std::vector<CTimerLocker*>& lockers, std::chrono::nanoseconds window, std::vector<int>& histogram);
+
+    ///  @brief : 모든 Timing wheel 의 OS Timer 가 초당 깨어나는 횟수를 반환 한다.
+    ///           주기가 서로 나누어 떨어지지 않는 CTimerLocker 는 별도의 wheel 로 분리되어 이 값이 최소가 되도록 배치 된다.
+    ///  @return : 초당 wakeup 수
+    double GetWakeupRate();
+
+    ///  @brief : 사용중인 Timing wheel (OS Timer) 의 수를 반환 한다.
+    ///  @return : Timing wheel 의 수
+    size_t GetTimerWheelCount();
+
+    ///  @brief : CTimerLocker callback 을 호출하는 방법을 설정 한다. CTimerLocker 를 추가하기 전에 설정 한다.
+    ///           DISPATCH_EXECUTOR 이면 Timer 는 만료된 CTimerLocker 의 Wait() 만 깨우고 callback 은 CTimerLocker 마다 하나의 작업으로
+    ///           executor 에 전달 하기 때문에 callback 이 오래 걸려도 다른 Timer 의 tick 이 늦어지지 않는다.
+    ///           같은 CTimerLocker 의 callback 은 동시에 호출되지 않으며, 이전 callback 이 끝나기 전에 만료된 event 는 다음 event 와 합쳐서 호출 된다.
+    ///           (OVERRUN_SKIP 이면 한번만 호출하고 합쳐진 수는 GetMissedCount() 에 포함, OVERRUN_BURST 이면 모두 호출)
+    ///           executor 로 전달된 callback 은 Timer lock 밖에서 호출되며 DeleteTimerLocker() 이후에는 호출되지 않지만
+    ///           이미 실행 중인 callback 은 끝까지 수행 된다.
+    ///  @param mode[in] : DISPATCH_INLINE 또는 DISPATCH_EXECUTOR
+    ///  @param executor[in] : 작업을 실행할 함수 (thread pool 등), 비어 있으면 내부 dispatch thread 하나를 사용 한다.
+    ///                        executor 는 manager 가 소멸되기 전에 전달받은 작업을 모두 실행해야 한다.
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴 (CTimerLocker 가 있으면 2)
+    int  SetDispatchMode(DispatchMode mode, const Executor& executor = Executor());
+
+    ///  @brief : CTimerLocker callback 을 호출하는 방법을 반환 한다.
+    ///  @return : DispatchMode
+    DispatchMode GetDispatchMode();
+
+    ///  @brief : 하나의 tick 에서 만료된 CTimerLocker 의 callback 을 모두 호출한 후에 호출되는 callback 을 등록 한다.
+    ///           CTimerLocker callback 에서는 작업을 모아두고 batch callback 에서 한번만 깨우는 용도로 사용 한다.
+    ///           DISPATCH_EXECUTOR 이면 같은 tick 에서 전달된 작업 중에 마지막으로 끝나는 작업에서 호출 된다.
+    ///  @param callback[in] : batch 가 끝날 때 호출되는 callback 함수
+    ///  @return : DeleteBatchCallback() 에서 사용할 식별자
+    int  AddBatchCallback(const CallBackBatch& callback);
+
+    ///  @brief : AddBatchCallback() 에서 등록한 callback 을 제거 한다.
+    ///  @param id[in] : AddBatchCallback() 에서 얻어온 식별자
+    ///  @return : 성공 여부
+    bool DeleteBatchCallback(int id);
+
+    ///  @brief : deadline 에 한번만 callback 을 호출하는 Timer task 를 등록 한다.
+    ///           Timing wheel 을 공유하기 때문에 task 마다 OS Timer 를 생성하지 않는다.
+    ///           deadline 이 tick 경계에 있거나 tick 이 최소 해상도 이하인 기존 wheel 에 배치하며, 그 wheel 의 tick 은 변경하지 않는다.
+    ///  @param id[out] : Timer task 의 식별자
+    ///  @param deadline[in] : callback 이 호출되는 시간 (steady_clock), 지난 시간이면 다음 tick 에 호출 된다.
+    ///  @param callback[in] : deadline 에 호출되는 callback 함수
+    ///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+    int  AddTimerTask(TimerTaskId& id, std::chrono::steady_clock::time_point deadline, const CallBackTimer& callback);
+
+    ///  @brief : AddTimerTask() 에서 등록한 Timer task 를 취소 한다. O(1)
+    ///  @param id[in] : AddTimerTask() 에서 얻어온 식별자
+    ///  @return : 성공 여부, 이미 호출 되었거나 취소된 task 이면 false
+    bool DeleteTimerTask(TimerTaskId id);
 };
 
+///  @brief : 최소 해상도 별로 CTimerLocker 의 주기 오차(jitter) 를 측정하여 출력 한다.
+int BenchTimerLockerJitter();
+
+///  @brief : Timing wheel 의 slot 에서 만료된 CTimerLocker 를 찾는 비용을 1k, 10k, 100k 개에 대해 측정하여 출력 한다.
+///           pointer 를 따라가는 방식, 만료 tick 배열 (SoA) 의 scalar 비교, SIMD 비교를 비교 한다.
+int BenchTimerLockerTick();
+
+///  @brief : 30 fps CTimerLocker 의 호출 간격이 1 ms 해상도에서 34/33/33 ms, 10 ms 해상도에서 40/30/30 ms 로 반복되고
+///           base tick 이 최소 해상도로 유지되는지 확인 한다.
+///           timer_ex::InitializeVirtualTimer() 로 초기화 된 후에 호출 한다.
+///  @return : 성공 시에 0, 실패 시에 1이상 값을 리턴
+int TestTimerLockerFps();
+
 // Sample code...
 #if 0
 #include <plog/Appenders/ColorConsoleAppender.h>
@@ -0,0 +1,147 @@
+﻿#include "TimerStats.h"
+
+#include <algorithm>
+#include <climits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static int GetHighestBit(unsigned long long value)
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanReverse64(&index, value);
+    return (int)index;
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+// class CTimerHistogram
+
+CTimerHistogram::CTimerHistogram()
+{
+    Reset();
+}
+
+// LINEAR_COUNT 이상은 최상위 bit 아래의 SUB_BUCKET_BITS 개 bit 로 구간 내부의 위치를 정한다.
+int CTimerHistogram::GetBucketIndex(long long value)
+{
+    if (value < LINEAR_COUNT)
+        return value > 0 ? (int)value : 0;
+
+    int highest = GetHighestBit((unsigned long long)value);
+    if (highest >= MAX_VALUE_BITS)
+        return BUCKET_COUNT - 1;
+
+    int sub = (int)(value >> (highest - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+    return LINEAR_COUNT + (highest - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT + sub;
+}
+
+long long CTimerHistogram::GetBucketUpperValue(int index)
+{
+    if (index < LINEAR_COUNT)
+        return index;
+
+    int highest = (index - LINEAR_COUNT) / SUB_BUCKET_COUNT + SUB_BUCKET_BITS + 1;
+    int sub     = (index - LINEAR_COUNT) % SUB_BUCKET_COUNT;
+    int shift   = highest - SUB_BUCKET_BITS;
+
+    return ((long long)(SUB_BUCKET_COUNT + sub + 1) << shift) - 1;
+}
+
+void CTimerHistogram::Record(long long value)
+{
+    m_counts[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    long long min = m_min.load(std::memory_order_relaxed);
+    while (value < min && false == m_min.compare_exchange_weak(min, value, std::memory_order_relaxed))
+        ;
+    long long max = m_max.load(std::memory_order_relaxed);
+    while (value > max && false == m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        ;
+}
+
+void CTimerHistogram::GetSnapshot(TimerHistogramSnapshot& snapshot) const
+{
+    snapshot = TimerHistogramSnapshot();
+
+    long long total = 0;
+    for (int index = 0; index < BUCKET_COUNT; index++)
+    {
+        long long count = m_counts[index].load(std::memory_order_relaxed);
+        if (count)
+        {
+            snapshot.buckets.push_back(std::make_pair(GetBucketUpperValue(index), count));
+            total += count;
+        }
+    }
+    if (0 == total)
+        return;
+
+    snapshot.count = total;
+    snapshot.min   = m_min.load(std::memory_order_relaxed);
+    snapshot.max   = m_max.load(std::memory_order_relaxed);
+    snapshot.mean  = (double)m_sum.load(std::memory_order_relaxed) / total;    // 따로 읽은 기록 수가 0 일 수 있으므로 bucket 합으로 나눈다.
+
+    // 백분위 값은 bucket 의 상한 값이며 실제 최대값 보다 크게 보고하지 않는다.
+    auto get_percentile = [&](double percentile) {
+        long long target = (long long)(total * percentile / 100.0 + 0.5);
+        long long sum    = 0;
+        for (const std::pair<long long, long long>& bucket : snapshot.buckets)
+        {
+            sum += bucket.second;
+            if (sum >= target)
+                return std::min(bucket.first, snapshot.max);
+        }
+        return snapshot.max;
+    };
+
+    snapshot.p50  = get_percentile(50.0);
+    snapshot.p90  = get_percentile(90.0);
+    snapshot.p99  = get_percentile(99.0);
+    snapshot.p999 = get_percentile(99.9);
+}
+
+void CTimerHistogram::Reset()
+{
+    for (std::atomic<uint32_t>& count : m_counts)
+        count.store(0, std::memory_order_relaxed);
+
+    m_sum.store(0, std::memory_order_relaxed);
+    m_min.store(LLONG_MAX, std::memory_order_relaxed);
+    m_max.store(LLONG_MIN, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// class CTimerStats
+
+void CTimerStats::Record(std::chrono::steady_clock::time_point fire, std::chrono::steady_clock::time_point deadline)
+{
+    long long fire_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(fire.time_since_epoch()).count();
+
+    long long last_fire = m_last_fire.exchange(fire_ns, std::memory_order_relaxed);
+    if (last_fire)
+        m_interval.Record(fire_ns - last_fire);
+
+    m_lateness.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(fire - deadline).count());
+}
+
+void CTimerStats::GetStats(TimerStats& stats) const
+{
+    m_interval.GetSnapshot(stats.interval);
+    m_lateness.GetSnapshot(stats.lateness);
+
+    stats.fire_count = stats.lateness.count;
+    stats.fps        = stats.interval.mean > 0 ? 1000000000.0 / stats.interval.mean : 0;
+}
+
+void CTimerStats::Reset()
+{
+    m_last_fire.store(0, std::memory_order_relaxed);
+    m_interval.Reset();
+    m_lateness.Reset();
+}
@@ -0,0 +1,96 @@
+﻿#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+///  @file    TimerStats.h
+///  @author  Lee Jong Oh
+///  @brief   CTimerLocker, RepeatWorkProc 의 Work 가 실제로 호출된 간격과 지연을 측정하는 통계
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+
+///  @brief   CTimerHistogram 의 특정 시점 값
+struct TimerHistogramSnapshot
+{
+    long long   count = 0;
+    long long   min   = 0;      // 기록된 가장 작은 값 (nanosecond)
+    long long   max   = 0;      // 기록된 가장 큰 값 (nanosecond)
+    double      mean  = 0;
+    long long   p50   = 0;      // 백분위 값 (nanosecond), bucket 의 상한 값이기 때문에 최대 6.25% 크게 보고 된다.
+    long long   p90   = 0;
+    long long   p99   = 0;
+    long long   p999  = 0;
+
+    std::vector<std::pair<long long, long long>>  buckets;  // 값이 있는 bucket 의 (상한 값, 개수)
+};
+
+///  @brief   CTimerLocker, Work 의 통계
+struct TimerStats
+{
+    long long               fire_count = 0;     // 측정된 호출 수
+    double                  fps = 0;            // 평균 호출 간격으로 계산한 초당 호출 수
+    TimerHistogramSnapshot  interval;           // 이전 호출과의 간격
+    TimerHistogramSnapshot  lateness;           // deadline 대비 지연, 일찍 호출된 경우는 0 bucket 에 기록 된다.
+};
+
+//////////////////////////////////////////////////////////////////////////
+///  @class   CTimerHistogram
+///  @brief   HDR histogram 과 같은 log-linear bucket 으로 nanosecond 값을 기록 한다.
+///           32 ns 미만은 1 ns 단위, 그 이상은 2의 거듭제곱 구간을 16개로 나누어 상대 오차 6.25% 이내로 기록 한다.
+///           Record() 는 lock 없이 relaxed atomic 연산으로만 처리되어 Timer 처리 중에도 호출할 수 있다.
+
+class CTimerHistogram
+{
+public:
+    enum
+    {
+        SUB_BUCKET_BITS  = 4,
+        SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS,
+        LINEAR_COUNT     = SUB_BUCKET_COUNT * 2,    // 1 ns 단위로 기록하는 값의 수
+        MAX_VALUE_BITS   = 36,                      // 약 68초, 이보다 큰 값은 마지막 bucket 에 기록 된다.
+        BUCKET_COUNT     = LINEAR_COUNT + (MAX_VALUE_BITS - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT,
+    };
+
+private:
+    std::atomic<uint32_t>   m_counts[BUCKET_COUNT];
+    std::atomic<long long>  m_sum{ 0 };
+    std::atomic<long long>  m_min;
+    std::atomic<long long>  m_max;
+
+    static int       GetBucketIndex(long long value);
+    static long long GetBucketUpperValue(int index);
+
+public:
+    CTimerHistogram();
+
+    ///  @brief : 값을 기록 한다. 음수는 0 bucket 에 기록되고 min 에는 그대로 반영 된다. lock-free
+    void Record(long long value);
+
+    ///  @brief : 기록된 값으로 snapshot 을 만든다. 기록 중에 호출되면 일부 값이 빠질 수 있다.
+    void GetSnapshot(TimerHistogramSnapshot& snapshot) const;
+
+    void Reset();
+};
+
+//////////////////////////////////////////////////////////////////////////
+///  @class   CTimerStats
+///  @brief   호출 시간과 deadline 으로 호출 간격, 지연 histogram 을 기록 한다.
+///           하나의 thread 에서 Record() 를 호출하고 다른 thread 에서 GetStats() 로 읽는다.
+
+class CTimerStats
+{
+private:
+    std::atomic<long long>  m_last_fire{ 0 };   // 마지막 호출 시간 (clock 의 epoch 기준 nanosecond), 0 이면 없음
+    CTimerHistogram         m_interval;
+    CTimerHistogram         m_lateness;
+
+public:
+    ///  @brief : 호출을 기록 한다.
+    ///  @param fire[in] : 호출된 시간
+    ///  @param deadline[in] : 호출 되어야 했던 시간
+    void Record(std::chrono::steady_clock::time_point fire, std::chrono::steady_clock::time_point deadline);
+
+    void GetStats(TimerStats& stats) const;
+    void Reset();
+};